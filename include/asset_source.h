@@ -0,0 +1,65 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <string>
+
+
+// Where a Decoder reads an asset from: a whole file, a byte range of a pack
+// file, or a block of memory kept alive by an owner handle. Sources are
+// plain addresses, the Decoder maps or opens them.
+class AssetSource
+{
+public:
+    AssetSource() = default;
+    AssetSource(const std::string& path) : path_(path) {}
+    AssetSource(const char* path) : path_(path) {}
+
+    // `length` bytes starting at `offset` of the pack; 0 means up to the end
+    static AssetSource region(const std::string& packPath, uint64_t offset, uint64_t length = 0)
+    {
+        AssetSource source(packPath);
+        source.offset_ = offset;
+        source.length_ = length;
+        return source;
+    }
+
+    // Bytes stay valid for as long as any copy of the source (or a decoder
+    // opened from it) holds `owner`
+    static AssetSource memory(const void* data, size_t size, std::shared_ptr<const void> owner,
+                              const std::string& name = "<memory>")
+    {
+        if (!data || size == 0)
+            throw std::runtime_error("Empty audio buffer: " + name);
+        AssetSource source(name);
+        source.data_ = static_cast<const uint8_t*>(data);
+        source.length_ = size;
+        source.owner_ = std::move(owner);
+        return source;
+    }
+
+    // File path (pack path for regions, display name for memory)
+    const std::string& path() const { return path_; }
+    uint64_t offset() const { return offset_; }
+    uint64_t length() const { return length_; }
+
+    bool is_file() const { return !data_ && offset_ == 0 && length_ == 0; }
+    bool is_memory() const { return data_ != nullptr; }
+    const uint8_t* data() const { return data_; }
+    const std::shared_ptr<const void>& owner() const { return owner_; }
+
+    // Path, "pack@offset+length" or the memory name, for error messages
+    std::string describe() const
+    {
+        if (is_file() || is_memory()) return path_;
+        return path_ + "@" + std::to_string(offset_) + "+" + std::to_string(length_);
+    }
+
+private:
+    std::string path_;
+    uint64_t offset_ = 0;
+    uint64_t length_ = 0;
+    const uint8_t* data_ = nullptr;
+    std::shared_ptr<const void> owner_;
+};
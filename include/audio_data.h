@@ -1,12 +1,32 @@
 #pragma once
 #include <cstdint>
+#include <climits>
+#include <cstring>
 #include <string>
 #include <vector>
 #include <stdexcept>
 #include <algorithm>
 #include <fstream>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <type_traits>
+#include "decoder.h"
+#include "sample_format.h"
 
 
+// Decoded interleaved PCM that owns its storage, so it can be handed out
+// (e.g. through the Python buffer protocol) without copying
+struct PCMData
+{
+    std::vector<uint8_t> data;
+    uint16_t channels = 0;
+    uint32_t sampleRate = 0;
+    SampleType sampleType = SampleType::Int16;
+
+    uint64_t frames() const { return channels ? data.size() / (channels * sample_size(sampleType)) : 0; }
+};
+
 // The implementation is self-explanatory
 // Refer to dr_wav, dr_mp3 and stb_vorbis docs to understand decoding
 class AudioData
@@ -21,6 +41,11 @@ public:
     double durationSeconds = 0.0;
     std::string sourcePath;
     bool forceMono = false;
+    size_t seekPoints = 0;
+    SampleType sampleType = SampleType::Int16;
+    // Detected from the file contents once, reused whenever the file is reopened
+    AudioFormat format = AudioFormat::Unknown;
+    AssetSource source;
 
     AudioData() = default;
 
@@ -41,10 +66,32 @@ public:
                 static_cast<double>(sampleRate);
         }
 
-    AudioData(const std::string& path, bool forceMono = false);
+    // An empty sample type picks the decoder's native one, so 24/32-bit WAV
+    // and float-decoded MP3/OGG skip the 16-bit quantisation. The source may
+    // be a path, a region of a pack file or a block of memory
+    AudioData(const AssetSource& source, bool forceMono = false,
+              std::optional<SampleType> type = SampleType::Int16);
     
     std::vector<uint8_t> decode() const;
-    std::vector<uint8_t> decodeMP3() const;
-    std::vector<uint8_t> decodeOGG() const;
-    std::vector<uint8_t> decodeWAV() const;
+    PCMData decodePCM() const { return { decode(), channels, sampleRate, sampleType }; }
+
+    // Bytes needed to hold the whole decoded file in sampleType
+    size_t decodedSize() const;
+
+    // Decode straight into caller memory holding maxFrames frames of
+    // `channels` samples of sampleType, no intermediate copies. Returns frames written.
+    uint64_t decodeInto(void* out, uint64_t maxFrames) const;
+
+private:
+    // Decoder opened while probing, handed to the first decode so the file is
+    // opened (and an MP3 scanned) only once. Copies share the slot; later
+    // decodes open the file again.
+    struct ProbedDecoder
+    {
+        std::mutex mutex;
+        std::unique_ptr<Decoder> decoder;
+    };
+    std::shared_ptr<ProbedDecoder> probed_;
+
+    std::unique_ptr<Decoder> take_decoder() const;
 };
\ No newline at end of file
@@ -0,0 +1,21 @@
+#pragma once
+#include <memory>
+#include <string>
+#include <vector>
+#include "buffer.h"
+
+
+// Loads many assets at once: worker threads probe and decode files, while
+// the calling thread uploads finished PCM with alBufferData as it arrives.
+// Workers wait once `threads` decoded files are queued, so at most about
+// twice the thread count of decoded files are held in memory at a time
+class BatchLoader
+{
+public:
+    // threads == 0 uses one worker per hardware thread. Buffers are returned
+    // in input order; the first decode error is rethrown after all workers stop.
+    static std::vector<std::shared_ptr<Buffer>> load(const std::vector<std::string>& paths,
+                                                     size_t threads = 0,
+                                                     bool forceMono = false,
+                                                     SampleType type = SampleType::Int16);
+};
@@ -7,6 +7,7 @@ class Buffer
 {
 public:
     Buffer(const AudioData& audio);
+    explicit Buffer(const PCMData& pcm);
     ~Buffer();
 
     Buffer(const Buffer&) = delete;
@@ -16,7 +17,21 @@ public:
     Buffer& operator=(Buffer&& other) noexcept;
 
     unsigned int id() const { return id_; }
+    size_t size() const { return size_; }
+    // Playback length in seconds at pitch 1
+    double duration() const { return duration_; }
+
+    // AL format enum for the layout, throws if the current context cannot
+    // take it (float needs AL_EXT_FLOAT32, more than two channels AL_EXT_MCFORMATS)
+    static int format_for(uint16_t channels, SampleType type);
+    static bool float32_supported();
+    static bool multichannel_supported();
     
 private:
+    void upload(const std::vector<uint8_t>& pcm, uint16_t channels, uint32_t sampleRate,
+                SampleType type, const std::string& name);
+
     unsigned int id_ = 0;
+    size_t size_ = 0;
+    double duration_ = 0.0;
 };
@@ -0,0 +1,44 @@
+#pragma once
+#include <filesystem>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include "buffer.h"
+
+
+// Process-wide cache of uploaded Buffers. Entries are keyed by canonical path,
+// forceMono and sample type and are reloaded when the file's modification time changes.
+// Handles are shared, so evicting an entry only drops the cache's reference;
+// the AL buffer lives until the last handle is gone.
+class BufferCache
+{
+public:
+    static std::shared_ptr<Buffer> get(const std::string& path, bool forceMono = false,
+                                       SampleType type = SampleType::Int16);
+
+    // Least recently used entries are evicted while the cached PCM exceeds the budget
+    static void set_budget(size_t bytes);
+    static size_t get_budget();
+
+    static size_t get_bytes();
+    static size_t get_count();
+    static void clear();
+
+private:
+    struct Entry
+    {
+        std::filesystem::file_time_type mtime;
+        std::shared_ptr<Buffer> buffer;
+        std::list<std::string>::iterator lru;
+    };
+
+    static std::string make_key(const std::string& canonicalPath, bool forceMono, SampleType type);
+    static void evict();
+
+    static inline std::mutex mutex_;
+    static inline std::unordered_map<std::string, Entry> entries_;
+    static inline std::list<std::string> lru_;
+    static inline size_t bytes_ = 0;
+    static inline size_t budget_ = 256 * 1024 * 1024;
+};
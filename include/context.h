@@ -1,11 +1,15 @@
 #pragma once
+#include <memory>
+#include <vector>
 #include "device.h"
+#include "source_pool.h"
 
 
 class Context
 {
 public:
     explicit Context(Device& device);
+    explicit Context(LoopbackDevice& device);
     ~Context();
 
     Context(const Context&) = delete;
@@ -16,6 +20,41 @@ public:
 
     bool is_valid() const { return context_ != nullptr; }
 
+    // AL_SOFT_deferred_updates: listener and source changes made between
+    // begin_batch() and the matching end_batch() reach the mixer together.
+    // Batches nest, only the outermost end applies them. Without the
+    // extension both calls do nothing and changes apply immediately.
+    void begin_batch();
+    void end_batch();
+    bool in_batch() const { return batchDepth_ > 0; }
+    bool deferred_updates_supported() const { return deferSupported_; }
+
+    // Fire-and-forget playback on a voice pool owned by the context, created
+    // on first use. Finished voices are reclaimed by later calls, so nothing
+    // needs to be kept or updated by the caller. Returns false when every
+    // voice is busy with a higher priority.
+    bool play_oneshot(std::shared_ptr<const Buffer> buffer, float x, float y, float z,
+                      float gain = 1.0f, float pitch = 1.0f, int priority = 0);
+    // Shared so handles taken from it stay usable after the context lets go
+    std::shared_ptr<SourcePool> oneshot_pool();
+    // Drops the context's pool, the next one gets `count` voices
+    void set_oneshot_voices(size_t count);
+    size_t oneshot_voices() const { return oneshotVoices_; }
+
+    // The current AL context: the most recently created one still alive.
+    // Destroying it makes the one created before it current again.
+    static Context* current() { return live_.empty() ? nullptr : live_.back(); }
+
 private:
+    void create(void* device, const int* attributes);
+    void destroy();
+
+    // Live contexts in creation order, the current one last
+    static inline std::vector<Context*> live_;
+
     void* context_ = nullptr;
+    std::shared_ptr<SourcePool> oneshots_;
+    size_t oneshotVoices_ = 64;
+    int batchDepth_ = 0;
+    bool deferSupported_ = false;
 };
\ No newline at end of file
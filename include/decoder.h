@@ -0,0 +1,110 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <stdexcept>
+#include <vector>
+#include "asset_source.h"
+#include "mapped_file.h"
+#include "sample_format.h"
+
+
+enum class AudioFormat { MP3, OGG, WAV, Unknown };
+
+// Mirrors drmp3_seek_point so tables can be stored without exposing dr_mp3
+struct SeekPoint
+{
+    uint64_t seekPosInBytes;
+    uint64_t pcmFrameIndex;
+    uint16_t mp3FramesToDiscard;
+    uint16_t pcmFramesToDiscard;
+};
+
+struct FileRegion;
+
+// Thin owner of an open dr_wav / dr_mp3 / stb_vorbis handle that reads
+// interleaved 16-bit or float frames. Probed values are cached, so expensive queries
+// (the MP3 frame count scans the whole file) run at most once per open.
+class Decoder
+{
+public:
+    // An Unknown format is detected from the leading bytes of the source
+    explicit Decoder(const AssetSource& source, AudioFormat format = AudioFormat::Unknown);
+    ~Decoder();
+
+    Decoder(const Decoder&) = delete;
+    Decoder& operator=(const Decoder&) = delete;
+
+    // Shared factory for AudioData and Stream
+    static std::unique_ptr<Decoder> open(const AssetSource& source, AudioFormat format = AudioFormat::Unknown);
+
+    static AudioFormat detect_format(const std::string& path);
+    static AudioFormat sniff_format(const uint8_t* header, size_t size);
+    static AudioFormat format_from_path(const std::string& path);
+
+    AudioFormat format() const { return format_; }
+    uint32_t sample_rate() const { return sampleRate_; }
+    uint16_t channels() const { return channels_; }
+    uint64_t frame_count();
+    // True when frame_count() needs no pass over the file: WAV and OGG
+    // headers, an MP3 Xing/Info tag or a loaded seek index
+    bool frame_count_known() const;
+
+    // Float32 when 16-bit output would lose precision: MP3/OGG (decoded in
+    // float) and WAV stored with more than 16 bits or as float
+    SampleType native_sample_type() const;
+
+    // Returns frames read, 0 at the end of the stream
+    uint64_t read(int16_t* out, uint64_t frames);
+    uint64_t read(float* out, uint64_t frames);
+    bool seek(uint64_t frame);
+
+    // MP3 only: calculate and bind a seek table (roughly one point per
+    // second) so seeks jump close to the target instead of decoding from the
+    // start. With the seek index enabled the table and frame count of a plain
+    // file are read from / written to "<path>.seekidx". Returns the number
+    // of seek points.
+    size_t build_seek_table();
+    size_t seek_point_count() const { return seekPoints_.size(); }
+
+    // Process-wide switch for the MP3 sidecar seek index files
+    static void set_seek_index_enabled(bool enable) { seekIndexEnabled_.store(enable, std::memory_order_relaxed); }
+    static bool get_seek_index_enabled() { return seekIndexEnabled_.load(std::memory_order_relaxed); }
+
+    // Process-wide switch for memory-mapped input (off by default); files that
+    // cannot be mapped are always read through stdio. Only enable it for
+    // assets that are not modified while in use: truncating or rewriting a
+    // mapped file in place under a decoder raises SIGBUS on POSIX, where
+    // stdio input would just see a short read.
+    static void set_mmap_enabled(bool enable) { mmapEnabled_.store(enable, std::memory_order_relaxed); }
+    static bool get_mmap_enabled() { return mmapEnabled_.load(std::memory_order_relaxed); }
+    // True when decoding from memory (a mapping or a caller's buffer)
+    bool is_mapped() const { return bytes_ != nullptr; }
+
+private:
+    bool load_seek_index();
+    void save_seek_index() const;
+
+    void open_input(bool allowMapping);
+    AudioFormat sniff_input();
+
+    AssetSource source_;
+    // Memory input: a MappedFile or the caller's owner handle keeps bytes_ alive
+    std::shared_ptr<const void> input_;
+    const uint8_t* bytes_ = nullptr;
+    size_t byteCount_ = 0;
+    // Stdio input for regions of files that are not mapped
+    std::unique_ptr<FileRegion> region_;
+    void* handle_ = nullptr;
+    AudioFormat format_ = AudioFormat::Unknown;
+    uint32_t sampleRate_ = 0;
+    uint16_t channels_ = 0;
+    uint64_t frameCount_ = 0;
+    bool frameCountKnown_ = false;
+    std::vector<SeekPoint> seekPoints_;
+
+    // Set from Python while worker threads decode with the GIL released
+    static inline std::atomic<bool> seekIndexEnabled_{ false };
+    static inline std::atomic<bool> mmapEnabled_{ false };
+};
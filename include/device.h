@@ -1,5 +1,8 @@
 #pragma once
+#include <algorithm>
+#include <cstdint>
 #include "openal_loader.h"
+#include "sample_format.h"
 
 
 class Device
@@ -20,3 +23,40 @@ public:
 private:
     void* device_ = nullptr;
 };
+
+// Device without audio hardware (ALC_SOFT_loopback). Nothing is played back,
+// the mix is pulled by the caller through render() as fast as the CPU allows.
+class LoopbackDevice
+{
+public:
+    explicit LoopbackDevice(int sampleRate = 44100, int channels = 2, SampleType type = SampleType::Int16);
+    ~LoopbackDevice();
+
+    LoopbackDevice(const LoopbackDevice&) = delete;
+    LoopbackDevice& operator=(const LoopbackDevice&) = delete;
+
+    LoopbackDevice(LoopbackDevice&& other) noexcept;
+    LoopbackDevice& operator=(LoopbackDevice&& other) noexcept;
+
+    // Mix the next `frames` frames of the current context into `out`, which
+    // must hold at least frames * frame_size() bytes
+    void render(void* out, int frames);
+
+    void* handle() const { return device_; }
+    bool is_valid() const { return device_ != nullptr; }
+
+    // Context attributes describing the render format, zero terminated
+    const int* attributes() const { return attributes_; }
+
+    int sample_rate() const { return sampleRate_; }
+    int channels() const { return channels_; }
+    SampleType sample_type() const { return type_; }
+    size_t frame_size() const;
+
+private:
+    void* device_ = nullptr;
+    int sampleRate_ = 0;
+    int channels_ = 0;
+    SampleType type_ = SampleType::Int16;
+    int attributes_[7] = {};
+};
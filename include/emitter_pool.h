@@ -0,0 +1,97 @@
+#pragma once
+#include <cfloat>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <vector>
+#include "source_pool.h"
+
+
+// Virtual voices: any number of emitters share a fixed SourcePool. Every
+// update() ranks the playing emitters by priority and audibility and only
+// the best ones hold a real AL source. The rest are virtual: they use no
+// source or mixer time but keep a playback clock running, and are re-bound
+// at the matching offset once they are audible again. Emitters are named by
+// ids; calls with the id of a finished or removed emitter are ignored.
+class EmitterPool
+{
+public:
+    // `voices` real sources at most; emitters quieter than `threshold`
+    // (gain after distance attenuation) are never bound
+    explicit EmitterPool(size_t voices, float threshold = 0.001f);
+
+    EmitterPool(const EmitterPool&) = delete;
+    EmitterPool& operator=(const EmitterPool&) = delete;
+
+    // Starts an emitter at offset 0; it is bound on the next update()
+    uint64_t play(std::shared_ptr<const Buffer> buffer, float x, float y, float z,
+                  float gain = 1.0f, float pitch = 1.0f, bool looping = false, int priority = 0);
+    void stop(uint64_t id);
+
+    void set_position(uint64_t id, float x, float y, float z);
+    void set_gain(uint64_t id, float gain);
+    void set_pitch(uint64_t id, float pitch);
+    // Beyond `maxDistance` an emitter counts as silent. Like gain and pitch,
+    // values below the valid range (or NaN) are clamped to it
+    void set_distances(uint64_t id, float referenceDistance, float maxDistance = FLT_MAX,
+                       float rolloffFactor = 1.0f);
+
+    // False once a one-shot emitter reached its end or was stopped
+    bool is_playing(uint64_t id) const;
+    // True while the emitter holds an AL source
+    bool is_real(uint64_t id) const;
+    // Playback position in seconds, real or virtual
+    double offset(uint64_t id) const;
+
+    // Retires finished emitters, virtualizes the inaudible ones and binds
+    // the best virtual ones to free sources. Call once per frame.
+    void update();
+
+    void set_threshold(float threshold) { threshold_ = threshold; }
+    float threshold() const { return threshold_; }
+    size_t voices() const { return pool_.size(); }
+    size_t emitter_count() const { return live_; }
+    size_t real_count() const { return pool_.active_count(); }
+
+private:
+    struct Emitter
+    {
+        // Starts at 1 so no valid id is 0
+        uint32_t generation = 1;
+        bool live = false;
+        bool looping = false;
+        int priority = 0;
+        std::shared_ptr<const Buffer> buffer;
+        float position[3] = { 0.0f, 0.0f, 0.0f };
+        float gain = 1.0f;
+        float pitch = 1.0f;
+        float referenceDistance = 1.0f;
+        float maxDistance = FLT_MAX;
+        float rolloffFactor = 1.0f;
+        // Clock: offset() = anchorOffset + (now - anchorTime) * pitch
+        double anchorTime = 0.0;
+        double anchorOffset = 0.0;
+        std::optional<Voice> voice;
+        // Scratch for update()
+        float level = 0.0f;
+    };
+
+    static double now();
+    Emitter* find(uint64_t id);
+    const Emitter* find(uint64_t id) const;
+    double clock(const Emitter& emitter, double time) const;
+    void rebase(Emitter& emitter, double time, double offset);
+    float audibility(const Emitter& emitter, const float* listener) const;
+    void bind(Emitter& emitter, double time);
+    void unbind(Emitter& emitter, double time);
+    void retire(uint32_t index);
+
+    SourcePool pool_;
+    float threshold_;
+    std::vector<Emitter> emitters_;
+    std::vector<uint32_t> free_;
+    size_t live_ = 0;
+    // Reused by update()
+    std::vector<uint32_t> candidates_;
+    std::vector<uint32_t> real_;
+};
@@ -0,0 +1,45 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+
+// Read-only memory mapping of a whole file. Mappings are shared: every
+// acquire() of the same unchanged file returns the same view, so many
+// decoders on one asset read the same page-cache pages without read() copies.
+// A view is only reused while the file's mtime and size are unchanged; the
+// file must not be truncated under a live view (SIGBUS on POSIX).
+class MappedFile
+{
+public:
+    // Returns nullptr when the file cannot be mapped (missing, empty or the
+    // platform refuses), callers then fall back to regular file I/O
+    static std::shared_ptr<const MappedFile> acquire(const std::string& path);
+
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    const uint8_t* data() const { return data_; }
+    size_t size() const { return size_; }
+
+private:
+    MappedFile() = default;
+    bool map(const std::string& path);
+
+    const uint8_t* data_ = nullptr;
+    size_t size_ = 0;
+    std::filesystem::file_time_type mtime_;
+#ifdef _WIN32
+    void* file_ = nullptr;
+    void* mapping_ = nullptr;
+#endif
+
+    static inline std::mutex mutex_;
+    static inline std::unordered_map<std::string, std::weak_ptr<const MappedFile>> mappings_;
+};
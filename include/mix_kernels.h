@@ -0,0 +1,31 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+
+// Channel remix kernels shared by AudioData and Stream. Layouts follow the
+// AL_EXT_MCFORMATS channel order (FL FR FC LFE ...). Only the stereo to mono
+// path is vectorised (AVX2 or SSE2 picked at runtime on x86, NEON on ARM,
+// with a scalar fallback); other layouts and remix() use a scalar weighted
+// matrix loop.
+
+// Fold interleaved frames down to mono. Stereo averages L and R, larger
+// layouts use mono_downmix_weights(). `out` may alias `in`.
+void downmix_mono(const int16_t* in, int16_t* out, uint16_t channels, size_t frames);
+void downmix_mono(const float* in, float* out, uint16_t channels, size_t frames);
+
+// N to M remix with a row-major outChannels x inChannels matrix. `out` may
+// alias `in` when outChannels <= inChannels. Throws for more than 8 output
+// channels, the widest layout AL can play.
+void remix(const int16_t* in, uint16_t inChannels, int16_t* out, uint16_t outChannels,
+           const float* matrix, size_t frames);
+void remix(const float* in, uint16_t inChannels, float* out, uint16_t outChannels,
+           const float* matrix, size_t frames);
+
+// Normalised mono weights: centre at +3 dB relative to the fronts, surrounds
+// at -3 dB, LFE dropped
+std::vector<float> mono_downmix_weights(uint16_t channels);
+
+// Name of the kernel set selected for this CPU ("avx2", "sse2", "neon", "scalar")
+const char* mix_kernel_name();
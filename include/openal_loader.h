@@ -4,10 +4,16 @@
 #include <stdexcept>
 #include <sstream>
 #include <filesystem>
+#ifdef _WIN32
 #include "windows.h"
+using LibraryHandle = HMODULE;
+#else
+#include <dlfcn.h>
+using LibraryHandle = void*;
+#endif
 
 
-// Prototypes for all ALC functions we wish to import from .dll
+// Prototypes for all ALC functions we wish to import from .dll/.so
 struct ALCFunctions
 {
     // Device functions
@@ -18,9 +24,18 @@ struct ALCFunctions
     void* (*alcCreateContext)(void*, const int*);
     void  (*alcDestroyContext)(void*);
     int   (*alcMakeContextCurrent)(void*);
+
+    // Extension functions
+    int   (*alcIsExtensionPresent)(void*, const char*);
+    void* (*alcGetProcAddress)(void*, const char*);
+
+    // ALC_SOFT_loopback (optional, nullptr when unavailable)
+    void* (*alcLoopbackOpenDeviceSOFT)(const char*);
+    int   (*alcIsRenderFormatSupportedSOFT)(void*, int, int, int);
+    void  (*alcRenderSamplesSOFT)(void*, void*, int);
 };
 
-// Prototypes for all AL functions we wish to import from .dll
+// Prototypes for all AL functions we wish to import from .dll/.so
 struct ALFunctions
 {
     // Buffer functions
@@ -40,6 +55,9 @@ struct ALFunctions
     void (*alSourceStop)(unsigned int);
     void (*alSourcePause)(unsigned int);
     void (*alSourceRewind)(unsigned int);
+    void (*alSourcePlayv)(int, const unsigned int*);
+    void (*alSourceStopv)(int, const unsigned int*);
+    void (*alSourcePausev)(int, const unsigned int*);
     void (*alSourceQueueBuffers)(unsigned int, int, const unsigned int*);
     void (*alSourceUnqueueBuffers)(unsigned int, int, unsigned int*);
     
@@ -50,15 +68,21 @@ struct ALFunctions
     void (*alGetListenerfv)(int, float*);
     void (*alListener3f)(int, float, float, float);
 
+    // AL_SOFT_deferred_updates (optional, nullptr when unavailable)
+    void (*alDeferUpdatesSOFT)();
+    void (*alProcessUpdatesSOFT)();
+
     // Other functions
     void (*alDistanceModel)(int);
     int  (*alGetInteger)(int);
+    char (*alIsExtensionPresent)(const char*);
+    int  (*alGetEnumValue)(const char*);
 };
 
 class OpenALLoader
 {
 public:
-    // Initialise from the provided .dll path
+    // Initialise from the provided .dll/.so path
     static bool init(const std::string& path = "");
 
     // Free resources and reset state
@@ -71,10 +95,10 @@ public:
     static ALFunctions& al();
 
 private:    
-    // Load the functions from the .dll at given path
+    // Load the functions from the .dll/.so at given path
     static bool load_library(const std::string& path);
 
-    static HMODULE lib_handle_;
+    static LibraryHandle lib_handle_;
     static std::mutex mutex_;
     static inline bool initialized_ = false;
     static inline std::string dll_path_;
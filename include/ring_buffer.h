@@ -0,0 +1,83 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstring>
+#include <vector>
+#include <algorithm>
+
+
+// Lock-free single-producer / single-consumer ring of trivially copyable
+// elements. One thread may write while another reads; reset() and resize()
+// require both sides to be idle. The capacity is kept exact (not rounded to
+// a power of two) so callers moving whole frames never see a frame split
+// across the wrap point.
+template <typename T>
+class RingBuffer
+{
+public:
+    RingBuffer() = default;
+    explicit RingBuffer(size_t capacity) { resize(capacity); }
+
+    RingBuffer(const RingBuffer&) = delete;
+    RingBuffer& operator=(const RingBuffer&) = delete;
+
+    void resize(size_t capacity)
+    {
+        data_.assign(capacity, T());
+        reset();
+    }
+
+    void reset()
+    {
+        head_.store(0, std::memory_order_relaxed);
+        tail_.store(0, std::memory_order_relaxed);
+    }
+
+    size_t capacity() const { return data_.size(); }
+
+    // Elements ready for the consumer
+    size_t available() const
+    {
+        return head_.load(std::memory_order_acquire) - tail_.load(std::memory_order_relaxed);
+    }
+
+    // Space left for the producer
+    size_t free_space() const
+    {
+        return capacity() - (head_.load(std::memory_order_relaxed) - tail_.load(std::memory_order_acquire));
+    }
+
+    // Producer side: contiguous writable region (may be shorter than
+    // free_space() at the wrap point), then commit what was written
+    T* write_region(size_t& count)
+    {
+        size_t head = head_.load(std::memory_order_relaxed);
+        size_t start = capacity() ? head % capacity() : 0;
+        count = std::min(free_space(), capacity() - start);
+        return data_.data() + start;
+    }
+
+    void commit_write(size_t count)
+    {
+        head_.store(head_.load(std::memory_order_relaxed) + count, std::memory_order_release);
+    }
+
+    // Consumer side: copy up to count elements out, returns elements read
+    size_t read(T* out, size_t count)
+    {
+        size_t tail = tail_.load(std::memory_order_relaxed);
+        count = std::min(count, available());
+        if (count == 0) return 0;
+        size_t start = tail % capacity();
+        size_t first = std::min(count, capacity() - start);
+        std::memcpy(out, data_.data() + start, first * sizeof(T));
+        std::memcpy(out + first, data_.data(), (count - first) * sizeof(T));
+        tail_.store(tail + count, std::memory_order_release);
+        return count;
+    }
+
+private:
+    std::vector<T> data_;
+    std::atomic<size_t> head_{0};
+    std::atomic<size_t> tail_{0};
+};
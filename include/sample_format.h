@@ -0,0 +1,17 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+
+// Sample encodings shared by decoding, buffer upload and loopback rendering.
+// The values double as the ALC_SOFT_loopback sample type enums.
+enum class SampleType
+{
+    Int16 = 0x1402,
+    Float32 = 0x1406
+};
+
+inline size_t sample_size(SampleType type)
+{
+    return type == SampleType::Float32 ? sizeof(float) : sizeof(int16_t);
+}
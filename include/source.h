@@ -1,4 +1,5 @@
 #pragma once
+#include <cfloat>
 #include "buffer.h"
 
 
@@ -49,5 +50,23 @@ public:
     unsigned int id() const { return id_; }
 
 private:
+    // Client-side mirror of the write-only properties, so getters do not
+    // query AL. Playback state and offset change on the mixer thread and
+    // are always read from AL.
+    struct Properties
+    {
+        bool  looping = false;
+        bool  relative = false;
+        float gain = 1.0f;
+        float pitch = 1.0f;
+        float referenceDistance = 1.0f;
+        float rolloffFactor = 1.0f;
+        float maxDistance = FLT_MAX;
+    };
+
     unsigned int id_ = 0;
+    Properties props_;
+    // play() was called and no stop/reset followed; only then can the
+    // source still be playing, which is when play() has to check
+    bool started_ = false;
 };
\ No newline at end of file
@@ -0,0 +1,58 @@
+#pragma once
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include "buffer.h"
+
+
+enum class SourceState : uint8_t { Initial = 0, Playing = 1, Paused = 2, Stopped = 3 };
+
+// Many AL sources driven together. Ids and per-source state live in
+// contiguous arrays so a frame's worth of updates is one call. Bulk setters
+// compare against a client-side mirror and only touch sources whose value
+// changed; play/stop/pause go through the alSource*v entry points.
+// Index lists select a subset, an empty list means every source.
+class SourceGroup
+{
+public:
+    explicit SourceGroup(size_t size);
+    ~SourceGroup();
+
+    SourceGroup(const SourceGroup&) = delete;
+    SourceGroup& operator=(const SourceGroup&) = delete;
+
+    size_t size() const { return ids_.size(); }
+    unsigned int id(size_t index) const;
+
+    // size() rows of x, y, z / size() values
+    void set_positions(const float* xyz);
+    void set_velocities(const float* xyz);
+    void set_gains(const float* gains);
+    void set_pitches(const float* pitches);
+
+    // Stops the selected sources, AL cannot swap a playing one's buffer
+    void set_buffer(std::shared_ptr<const Buffer> buffer, const std::vector<uint32_t>& indices = {});
+    void set_looping(bool loop, const std::vector<uint32_t>& indices = {});
+
+    void play(const std::vector<uint32_t>& indices = {});
+    void stop(const std::vector<uint32_t>& indices = {});
+    void pause(const std::vector<uint32_t>& indices = {});
+
+    // Writes size() entries, mapped from AL_SOURCE_STATE
+    void states(SourceState* out) const;
+    size_t playing_count() const;
+
+private:
+    const std::vector<unsigned int>& select(const std::vector<uint32_t>& indices);
+
+    std::vector<unsigned int> ids_;
+    std::vector<float> positions_;
+    std::vector<float> velocities_;
+    std::vector<float> gains_;
+    std::vector<float> pitches_;
+    // uint8_t, not vector<bool>, so entries are plain bytes
+    std::vector<uint8_t> looping_;
+    std::vector<std::shared_ptr<const Buffer>> buffers_;
+    // Reused id list for subset calls
+    std::vector<unsigned int> selected_;
+};
@@ -0,0 +1,126 @@
+#pragma once
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <vector>
+#include "buffer.h"
+
+
+class SourcePool;
+
+// Lightweight handle to one pooled AL source. A handle goes stale once its
+// voice is reclaimed or stolen; calls on a stale handle are ignored.
+class Voice
+{
+public:
+    bool valid() const;
+    // False while paused, like Source::is_playing
+    bool is_playing() const;
+    int priority() const;
+    unsigned int id() const;
+
+    void play();
+    void pause();
+    void stop();
+
+    // The voice keeps the buffer alive until it is reclaimed
+    void set_buffer(std::shared_ptr<const Buffer> buffer);
+    void set_looping(bool loop);
+    void set_gain(float gain);
+    void set_pitch(float pitch);
+    void set_relative(bool relative);
+    // Negative or NaN distances and factors are ignored, as in Source
+    void set_reference_distance(float distance);
+    void set_rolloff_factor(float factor);
+    void set_max_distance(float distance);
+    void set_position(float x, float y, float z);
+    void set_velocity(float x, float y, float z);
+    // Playback position in seconds; set before play() to start part-way in
+    void set_offset(float seconds);
+    float offset() const;
+
+private:
+    friend class SourcePool;
+    Voice(SourcePool* pool, uint32_t slot, uint32_t generation)
+        : pool_(pool), slot_(slot), generation_(generation) {}
+
+    SourcePool* pool_;
+    uint32_t slot_;
+    uint32_t generation_;
+};
+
+// Fixed set of AL sources generated up front. Voices handed out by acquire()
+// return to the pool once they stop playing (a few are polled on every
+// acquire, all of them by update() and whenever the pool runs dry). When
+// every source is busy, the voice with the lowest priority is stolen, ties
+// going to the quietest / farthest one.
+// Like Source, a pool is used from one thread at a time.
+class SourcePool
+{
+public:
+    // Clamps to the number of sources the device can give, throws if none
+    explicit SourcePool(size_t size);
+    ~SourcePool();
+
+    SourcePool(const SourcePool&) = delete;
+    SourcePool& operator=(const SourcePool&) = delete;
+
+    // Empty when every voice is busy with a higher priority than `priority`
+    std::optional<Voice> acquire(int priority = 0);
+
+    // Acquire, set up and play a voice in one call; the voice is reclaimed
+    // automatically once it finishes. Returns false when nothing could be
+    // stolen at this priority.
+    bool play_oneshot(std::shared_ptr<const Buffer> buffer, float x, float y, float z,
+                      float gain = 1.0f, float pitch = 1.0f, int priority = 0);
+
+    // Return stopped voices to the pool, returns the number reclaimed
+    size_t update();
+
+    // Deletes the sources now, e.g. before their context goes away. The pool
+    // stays behind empty: every voice is stale and acquire() gives nothing.
+    void close();
+
+    size_t size() const { return ids_.size(); }
+    size_t free_count() const { return free_.size(); }
+    size_t active_count() const { return ids_.size() - free_.size(); }
+    uint64_t steals() const { return steals_; }
+
+private:
+    friend class Voice;
+
+    enum class SlotState : uint8_t { Free, Reserved, Playing };
+
+    // Client-side mirror of what a voice changed, so recycling only resets
+    // those properties and stealing can rank voices without AL queries
+    struct Slot
+    {
+        uint32_t generation = 0;
+        SlotState state = SlotState::Free;
+        int priority = 0;
+        uint32_t dirty = 0;
+        // Left changed in AL by an earlier voice, reset on play unless set
+        uint32_t stale = 0;
+        std::shared_ptr<const Buffer> buffer;
+        float gain = 1.0f;
+        float referenceDistance = 1.0f;
+        float rolloffFactor = 1.0f;
+        float position[3] = { 0.0f, 0.0f, 0.0f };
+        bool relative = false;
+    };
+
+    Slot* slot_for(const Voice& voice);
+    const Slot* slot_for(const Voice& voice) const;
+    void release(uint32_t slot, bool stopSource);
+    bool reclaim_if_stopped(uint32_t slot);
+    void reclaim_some(size_t count);
+    void flush_stale(uint32_t slot);
+    std::optional<uint32_t> pick_victim(int priority) const;
+    float audibility(const Slot& slot, const float* listener) const;
+
+    std::vector<unsigned int> ids_;
+    std::vector<Slot> slots_;
+    std::vector<uint32_t> free_;
+    uint64_t steals_ = 0;
+    uint32_t reclaimCursor_ = 0;
+};
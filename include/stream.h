@@ -1,12 +1,22 @@
 #pragma once
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <vector>
 #include "audio_data.h"
+#include "decoder.h"
 #include "openal_loader.h"
+#include "ring_buffer.h"
 
 
 class Stream
 {
 public:
-    Stream(const std::string& path, size_t bufferSize = 65536);
+    Stream(const AssetSource& source, size_t bufferSize = 65536, bool background = false,
+           size_t bufferCount = 4, bool adaptive = false,
+           std::optional<SampleType> type = SampleType::Int16);
     ~Stream();
 
     void update();
@@ -14,48 +24,115 @@ public:
     void pause();
     void stop();
 
+    // Only gain and pitch are mirrored client-side, clamped like Source
+    // (NaN included). Position and velocity have no getters
     void set_gain(float gain);
-    float get_gain() const;
+    float get_gain() const { return gain_; }
 
     void set_pitch(float pitch);
-    float get_pitch() const;
+    float get_pitch() const { return pitch_; }
 
     void set_offset(float seconds);
     float get_offset() const;
-    
+
     void set_looping(bool loop) { looping_ = loop; }
     bool get_looping() const { return looping_; }
-    
+
     void set_surround(bool enable);
     bool get_surround() const { return surround_; }
-    
+
+    // When enabled, the StreamWorker decodes ahead into a ring buffer and
+    // requeues AL buffers itself; update() becomes a no-op
+    void set_background(bool enable);
+    bool get_background() const { return background_; }
+
+    // Adaptive queue depth: an underrun adds an AL buffer (up to four times
+    // the configured count), a long stable run retires one again
+    void set_adaptive(bool enable) { adaptive_ = enable; }
+    bool get_adaptive() const { return adaptive_; }
+    size_t get_buffer_count() const;
+    uint64_t get_underruns() const { return underruns_; }
+
+    // Set when a background pass threw; the stream is stopped, the workers
+    // skip it from then on and play() raises the error
+    std::optional<std::string> get_error() const;
+
     void set_position(float x, float y, float z);
     void set_velocity(float x, float y, float z);
-    
+
     float get_progress() const;
     float get_total_duration() const { return duration_; }
+    SampleType get_sample_type() const { return sampleType_; }
+    // MP3 only; 0 until the first seek builds the table, unless the seek
+    // index is enabled
+    size_t get_seek_points() const { return decoder_->seek_point_count(); }
+
+    // Number of times the refill scratch buffer was (re)allocated; stays at
+    // one once the stream is running, confirming refills do not allocate
+    uint64_t get_scratch_allocations() const { return scratchAllocations_; }
 
 private:
+    friend class StreamWorker;
+
 unsigned int sourceId_ = 0;
-    unsigned int bufferIds_[4] = {0, 0, 0, 0};
+    std::vector<unsigned int> bufferIds_;
+    size_t bufferCount_;
+    std::atomic<bool> adaptive_ = false;
+    size_t stableRefills_ = 0;
+    std::atomic<uint64_t> underruns_ = 0;
 
-    void* handle_ = nullptr;
-    int format_ = 0;
+    std::unique_ptr<Decoder> decoder_;
     int alFormat_ = 0;
     int sampleRate_ = 0;
     int channels_ = 0;
+    SampleType sampleType_ = SampleType::Int16;
+    size_t frameSize_ = 0;
 
     std::string path_;
     size_t bufferSize_;
-    bool playing_ = false;
-    bool looping_ = false;
-    bool surround_ = false;
+    std::atomic<bool> playing_ = false;
+    std::atomic<bool> looping_ = false;
+    std::atomic<bool> surround_ = false;
+    float gain_ = 1.0f;
+    float pitch_ = 1.0f;
+    std::atomic<bool> background_ = false;
 
     uint64_t samplesProcessed_ = 0;
     double currentPlayheadBase_ = 0.0;
     float duration_ = 0.0f;
 
+    // decodeMutex_ guards the decoder handle and the ring's producer side,
+    // queueMutex_ guards the AL queue and the ring's consumer side.
+    // Control calls that reposition the stream take both (decode first).
+    mutable std::mutex decodeMutex_;
+    mutable std::mutex queueMutex_;
+    RingBuffer<uint8_t> ring_;
+    std::atomic<bool> decoderEnded_ = false;
+
+    // Reused by fill_buffer (under queueMutex_), left uninitialised on purpose
+    std::unique_ptr<uint8_t[]> scratch_;
+    size_t scratchSize_ = 0;
+    std::atomic<uint64_t> scratchAllocations_ = 0;
+
+    std::atomic<bool> failed_ = false;
+    mutable std::mutex errorMutex_;
+    std::string error_;
+
+    // Entry points for the StreamWorker threads, they take their own lock
+    void service_decode();
+    void service_queue();
+    void fail(const std::string& what);
+
+    size_t read_frames(uint8_t* out, size_t frames);
+    void decode_ahead();
+    void refill_queue();
+    void seek_frame(uint64_t frame);
+    void restart_at(uint64_t frame);
+    size_t ring_capacity() const;
+
+    uint8_t* scratch(size_t bytes);
     bool fill_buffer(unsigned int alBufferId);
-    void clear_handle();
+    void recycle_buffer(unsigned int alBufferId);
+    void on_underrun();
     void clear_queue();
-};
\ No newline at end of file
+};
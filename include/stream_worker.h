@@ -0,0 +1,42 @@
+#pragma once
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+
+class Stream;
+
+// Engine-owned threads servicing background Streams. The decode thread fills
+// each stream's ring buffer (producer), the feed thread moves ring data into
+// AL buffers and keeps the sources playing (consumer), so a slow decode or a
+// stalled Python thread never delays requeueing.
+class StreamWorker
+{
+public:
+    // Register a stream; starts the threads on first use
+    static void add(Stream* stream);
+
+    // Unregister a stream, waiting for any pass that is servicing it.
+    // Stops the threads once no streams remain.
+    static void remove(Stream* stream);
+
+    // Stops and joins both threads and forgets every stream, so the library
+    // can be unloaded; streams still alive switch back to being fed by
+    // update()
+    static void shutdown();
+
+private:
+    static void decode_loop();
+    static void feed_loop();
+    static void stop_threads();
+
+    static inline std::mutex controlMutex_;
+    static inline std::mutex decodeListMutex_;
+    static inline std::mutex feedListMutex_;
+    static inline std::vector<Stream*> decodeList_;
+    static inline std::vector<Stream*> feedList_;
+    static inline std::thread decodeThread_;
+    static inline std::thread feedThread_;
+    static inline std::atomic<bool> running_ = false;
+};
@@ -1,143 +1,92 @@
-#define DR_MP3_IMPLEMENTATION
-#define DR_WAV_IMPLEMENTATION
 #include "audio_data.h"
-#include "stb_vorbis.c"
-#include "dr_mp3.h"
-#include "dr_wav.h"
+#include "decoder.h"
+#include "mix_kernels.h"
 
 
-enum class Format { MP3, OGG, WAV, Unknown };
-
-static Format get_format(const std::string& path)
-{
-    size_t dot = path.find_last_of('.');
-    if (dot == std::string::npos) return Format::Unknown;
-    std::string ext = path.substr(dot + 1);
-    std::transform(ext.begin(), ext.end(), ext.begin(), ::tolower);
-    if (ext == "mp3") return Format::MP3;
-    if (ext == "ogg") return Format::OGG;
-    if (ext == "wav") return Format::WAV;
-    return Format::Unknown;
-}
-
-static std::vector<uint8_t> downmix_16bit(const int16_t* stereo, size_t frames)
+// Pull up to maxFrames frames from the decoder straight into `out`. When the
+// output is mono and the source is not, frames go through a small scratch
+// chunk and are downmixed, so the full-size interleaved PCM never exists.
+template <typename T>
+static uint64_t read_frames(Decoder& decoder, bool toMono, T* out, uint64_t maxFrames)
 {
-    std::vector<uint8_t> mono(frames * sizeof(int16_t));
-    int16_t* out = reinterpret_cast<int16_t*>(mono.data());
-    for (size_t i = 0; i < frames; ++i)
+    uint16_t srcChannels = decoder.channels();
+    if (!toMono || srcChannels == 1)
+    {
+        uint64_t total = 0;
+        while (total < maxFrames)
+        {
+            uint64_t n = decoder.read(out + total * srcChannels, maxFrames - total);
+            if (n == 0) break;
+            total += n;
+        }
+        return total;
+    }
+    constexpr uint64_t chunkFrames = 4096;
+    std::vector<T> chunk(chunkFrames * srcChannels);
+    uint64_t total = 0;
+    while (total < maxFrames)
     {
-        int32_t avg = (static_cast<int32_t>(stereo[i * 2]) + static_cast<int32_t>(stereo[i * 2 + 1])) / 2;
-        out[i] = static_cast<int16_t>(avg);
+        uint64_t n = decoder.read(chunk.data(), std::min(chunkFrames, maxFrames - total));
+        if (n == 0) break;
+        downmix_mono(chunk.data(), out + total, srcChannels, static_cast<size_t>(n));
+        total += n;
     }
-    return mono;
+    return total;
 }
 
-AudioData::AudioData(const std::string& path, bool forceMono) 
-    : sourcePath(path), forceMono(forceMono) 
+AudioData::AudioData(const AssetSource& source, bool forceMono, std::optional<SampleType> type) 
+    : sourcePath(source.describe()), forceMono(forceMono), source(source)
 {
-    Format fmt = get_format(path);
-    if (fmt == Format::WAV)
-    {
-        drwav wav;
-        if (!drwav_init_file(&wav, path.c_str(), nullptr)) 
-            throw std::runtime_error("WAV open error: " + path);
-        this->sampleRate = wav.sampleRate;
-        this->channels = (uint16_t)wav.channels;
-        this->totalFrames = wav.totalPCMFrameCount;
-        drwav_uninit(&wav);
-    } 
-    else if (fmt == Format::MP3)
-    {
-        drmp3 mp3;
-        if (!drmp3_init_file(&mp3, path.c_str(), nullptr)) 
-            throw std::runtime_error("MP3 open error: " + path);
-        this->sampleRate = mp3.sampleRate;
-        this->channels = (uint16_t)mp3.channels;
-        this->totalFrames = drmp3_get_pcm_frame_count(&mp3);
-        drmp3_uninit(&mp3);
-    } 
-    else if (fmt == Format::OGG)
-    {
-        int err;
-        stb_vorbis* v = stb_vorbis_open_filename(path.c_str(), &err, nullptr);
-        if (!v) throw std::runtime_error("OGG open error: " + path);
-        stb_vorbis_info i = stb_vorbis_get_info(v);
-        this->sampleRate = i.sample_rate;
-        this->channels = (uint16_t)i.channels;
-        this->totalFrames = stb_vorbis_stream_length_in_samples(v);
-        stb_vorbis_close(v);
-    }
-    else
-        throw std::runtime_error("Unsupported file extension: " + path);
+    auto decoder = Decoder::open(source);
+    this->format = decoder->format();
+    this->sampleRate = decoder->sample_rate();
+    this->channels = decoder->channels();
+    this->sampleType = type.value_or(decoder->native_sample_type());
+    this->bytesPerSample = static_cast<uint16_t>(sample_size(this->sampleType));
+    this->bitsPerSample = this->bytesPerSample * 8;
+    // A valid sidecar seek index also carries the frame count, skipping the MP3 scan
+    if (Decoder::get_seek_index_enabled())
+        this->seekPoints = decoder->build_seek_table();
+    // Header-only scan for an untagged MP3, the probed decoder is kept for decode()
+    this->totalFrames = decoder->frame_count();
+    probed_ = std::make_shared<ProbedDecoder>();
+    probed_->decoder = std::move(decoder);
     if (forceMono)
         this->channels = 1;
     this->totalSamples = this->totalFrames * this->channels;
     this->durationSeconds = static_cast<float>(this->totalFrames) / this->sampleRate;
 }
 
-std::vector<uint8_t> AudioData::decode() const
+std::unique_ptr<Decoder> AudioData::take_decoder() const
 {
-    switch (get_format(sourcePath))
+    if (probed_)
     {
-        case Format::MP3: return decodeMP3();
-        case Format::OGG: return decodeOGG();
-        case Format::WAV: return decodeWAV();
-        default: throw std::runtime_error("Unsupported format: " + sourcePath);
+        std::lock_guard lock(probed_->mutex);
+        if (probed_->decoder)
+            return std::move(probed_->decoder);
     }
+    return Decoder::open(source, format);
 }
 
-std::vector<uint8_t> AudioData::decodeWAV() const
+size_t AudioData::decodedSize() const
 {
-    drwav wav;
-    if (!drwav_init_file(&wav, sourcePath.c_str(), nullptr)) 
-        throw std::runtime_error("WAV init failed: " + sourcePath);
-    std::vector<int16_t> temp(totalFrames * wav.channels);
-    uint64_t framesRead = drwav_read_pcm_frames_s16(&wav, totalFrames, temp.data());
-    std::vector<uint8_t> result;
-    if (wav.channels == 2 && forceMono)
-        result = downmix_16bit(temp.data(), framesRead);
-    else
-    {
-        result.resize(temp.size() * sizeof(int16_t));
-        std::memcpy(result.data(), temp.data(), result.size());
-    }
-    drwav_uninit(&wav);
-    return result;
+    return static_cast<size_t>(totalFrames) * channels * sample_size(sampleType);
 }
 
-std::vector<uint8_t> AudioData::decodeOGG() const
+// Single allocation sized from the probed frame count, trimmed if the decoder
+// delivers fewer frames than reported
+std::vector<uint8_t> AudioData::decode() const
 {
-    int channels, sampleRate;
-    short* output = nullptr;
-    int frames = stb_vorbis_decode_filename(sourcePath.c_str(), &channels, &sampleRate, &output);
-    if (frames <= 0) throw std::runtime_error("OGG decode failed: " + sourcePath);
-    std::vector<uint8_t> result;
-    if (channels == 2 && forceMono)
-        result = downmix_16bit(output, frames);
-    else
-    {
-        size_t size = static_cast<size_t>(frames) * channels * sizeof(int16_t);
-        result.assign(reinterpret_cast<uint8_t*>(output), reinterpret_cast<uint8_t*>(output) + size);
-    }
-    free(output);
+    std::vector<uint8_t> result(decodedSize());
+    uint64_t frames = decodeInto(result.data(), totalFrames);
+    result.resize(static_cast<size_t>(frames) * channels * sample_size(sampleType));
     return result;
 }
 
-std::vector<uint8_t> AudioData::decodeMP3() const
+uint64_t AudioData::decodeInto(void* out, uint64_t maxFrames) const
 {
-    drmp3 mp3;
-    if (!drmp3_init_file(&mp3, sourcePath.c_str(), nullptr)) 
-        throw std::runtime_error("MP3 init failed: " + sourcePath);
-    std::vector<int16_t> temp(totalFrames * mp3.channels);
-    uint64_t framesRead = drmp3_read_pcm_frames_s16(&mp3, totalFrames, temp.data());
-    std::vector<uint8_t> result;
-    if (mp3.channels == 2 && forceMono)
-        result = downmix_16bit(temp.data(), framesRead);
-    else
-    {
-        result.resize(temp.size() * sizeof(int16_t));
-        std::memcpy(result.data(), temp.data(), result.size());
-    }
-    drmp3_uninit(&mp3);
-    return result;
-}
\ No newline at end of file
+    std::unique_ptr<Decoder> decoder = take_decoder();
+    if (sampleType == SampleType::Float32)
+        return read_frames(*decoder, forceMono, static_cast<float*>(out), maxFrames);
+    return read_frames(*decoder, forceMono, static_cast<int16_t*>(out), maxFrames);
+}
@@ -0,0 +1,96 @@
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include "batch_loader.h"
+
+
+std::vector<std::shared_ptr<Buffer>> BatchLoader::load(const std::vector<std::string>& paths,
+                                                       size_t threads,
+                                                       bool forceMono,
+                                                       SampleType type)
+{
+    std::vector<std::shared_ptr<Buffer>> buffers(paths.size());
+    if (paths.empty()) return buffers;
+    if (threads == 0)
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    threads = std::min(threads, paths.size());
+
+    // Workers claim the next unclaimed path, so a thread that draws short
+    // clips keeps pulling work while another is busy with a long one
+    std::atomic<size_t> next = 0;
+    std::atomic<bool> failed = false;
+    std::mutex mutex;
+    std::condition_variable ready;
+    std::condition_variable space;
+    std::deque<std::pair<size_t, PCMData>> decoded;
+    std::exception_ptr error;
+    size_t running = threads;
+
+    auto worker = [&]()
+    {
+        for (size_t i = next++; i < paths.size() && !failed; i = next++)
+        {
+            try
+            {
+                PCMData pcm = AudioData(paths[i], forceMono, type).decodePCM();
+                // Backpressure: wait while `threads` decoded files are queued
+                std::unique_lock lock(mutex);
+                space.wait(lock, [&]() { return decoded.size() < threads || failed; });
+                if (!failed)
+                    decoded.emplace_back(i, std::move(pcm));
+            }
+            catch (...)
+            {
+                std::lock_guard lock(mutex);
+                if (!error) error = std::current_exception();
+                failed = true;
+                space.notify_all();
+            }
+            ready.notify_one();
+        }
+        std::lock_guard lock(mutex);
+        --running;
+        ready.notify_one();
+    };
+
+    std::vector<std::thread> pool;
+    pool.reserve(threads);
+    for (size_t t = 0; t < threads; ++t)
+        pool.emplace_back(worker);
+
+    // Upload on the calling thread, which owns the current context
+    std::unique_lock lock(mutex);
+    while (true)
+    {
+        ready.wait(lock, [&]() { return !decoded.empty() || running == 0; });
+        if (decoded.empty()) break;
+        auto [index, pcm] = std::move(decoded.front());
+        decoded.pop_front();
+        space.notify_one();
+        if (failed) continue;
+        lock.unlock();
+        try
+        {
+            buffers[index] = std::make_shared<Buffer>(pcm);
+        }
+        catch (...)
+        {
+            lock.lock();
+            failed = true;
+            if (!error) error = std::current_exception();
+            space.notify_all();
+            continue;
+        }
+        lock.lock();
+    }
+    lock.unlock();
+
+    for (auto& thread : pool)
+        thread.join();
+    if (error)
+        std::rethrow_exception(error);
+    return buffers;
+}
@@ -4,37 +4,96 @@
 constexpr int AL_FORMAT_MONO16   = 0x1101;
 constexpr int AL_FORMAT_STEREO16 = 0x1103;
 
-static int to_al_format(uint16_t channels)
+// AL_EXT_MCFORMATS layouts by channel count (quad, 5.1, 6.1, 7.1);
+// the *32 variants are float
+static const char* multichannel_format_name(uint16_t channels, SampleType type)
 {
-    if (channels == 1) return AL_FORMAT_MONO16;
-    if (channels == 2) return AL_FORMAT_STEREO16;
+    bool isFloat = type == SampleType::Float32;
+    switch (channels)
+    {
+        case 4: return isFloat ? "AL_FORMAT_QUAD32" : "AL_FORMAT_QUAD16";
+        case 6: return isFloat ? "AL_FORMAT_51CHN32" : "AL_FORMAT_51CHN16";
+        case 7: return isFloat ? "AL_FORMAT_61CHN32" : "AL_FORMAT_61CHN16";
+        case 8: return isFloat ? "AL_FORMAT_71CHN32" : "AL_FORMAT_71CHN16";
+        default: return nullptr;
+    }
+}
+
+// An implementation can advertise an extension without knowing every enum
+// name in it; alGetEnumValue then gives 0, which alBufferData would only
+// reject as a generic AL_INVALID_ENUM
+static int extension_format(const char* name)
+{
+    int format = OpenALLoader::al().alGetEnumValue(name);
+    if (format == 0)
+        throw std::runtime_error(std::string("The OpenAL library does not know the format ") + name);
+    return format;
+}
+
+int Buffer::format_for(uint16_t channels, SampleType type)
+{
+    if (channels > 2)
+    {
+        const char* name = multichannel_format_name(channels, type);
+        if (!name)
+            throw std::runtime_error("Unsupported channel count: " + std::to_string(channels));
+        if (!multichannel_supported())
+            throw std::runtime_error("Multichannel audio needs AL_EXT_MCFORMATS, which the OpenAL library does not support");
+        if (type == SampleType::Float32 && !float32_supported())
+            throw std::runtime_error("Float32 audio needs AL_EXT_FLOAT32, which the OpenAL library does not support");
+        return extension_format(name);
+    }
+    if (type == SampleType::Int16)
+    {
+        if (channels == 1) return AL_FORMAT_MONO16;
+        if (channels == 2) return AL_FORMAT_STEREO16;
+        throw std::runtime_error("Unsupported channel count: " + std::to_string(channels));
+    }
+    if (!float32_supported())
+        throw std::runtime_error("Float32 audio needs AL_EXT_FLOAT32, which the OpenAL library does not support");
+    if (channels == 1) return extension_format("AL_FORMAT_MONO_FLOAT32");
+    if (channels == 2) return extension_format("AL_FORMAT_STEREO_FLOAT32");
     throw std::runtime_error("Unsupported channel count: " + std::to_string(channels));
 }
 
+bool Buffer::multichannel_supported()
+{
+    return OpenALLoader::al().alIsExtensionPresent("AL_EXT_MCFORMATS") != 0;
+}
+
+bool Buffer::float32_supported()
+{
+    return OpenALLoader::al().alIsExtensionPresent("AL_EXT_FLOAT32") != 0;
+}
+
 Buffer::Buffer(const AudioData& audio)
 {
+    upload(audio.decode(), audio.forceMono ? 1 : audio.channels, audio.sampleRate, audio.sampleType, audio.sourcePath);
+}
+
+Buffer::Buffer(const PCMData& pcm)
+{
+    upload(pcm.data, pcm.channels, pcm.sampleRate, pcm.sampleType, "PCM data");
+}
+
+void Buffer::upload(const std::vector<uint8_t>& pcm, uint16_t channels, uint32_t sampleRate,
+                    SampleType type, const std::string& name)
+{
+    if (pcm.empty())
+        throw std::runtime_error("Decoded audio is empty for: " + name);
+    int format = format_for(channels, type);
     OpenALLoader::al().alGenBuffers(1, &id_);
     if (!id_)
         throw std::runtime_error("Failed to create OpenAL buffer");
-    try
-    {
-        auto pcm = audio.decode();
-        if (pcm.empty())
-            throw std::runtime_error("Decoded audio is empty for: " + audio.sourcePath);
-        int format = to_al_format(audio.forceMono ? 1 : audio.channels);
-        OpenALLoader::al().alBufferData(
-            id_,
-            format,
-            pcm.data(),
-            static_cast<int>(pcm.size()),
-            audio.sampleRate
-        );
-    } 
-    catch (...)
-    {
-        OpenALLoader::al().alDeleteBuffers(1, &id_);
-        throw;
-    }
+    OpenALLoader::al().alBufferData(
+        id_,
+        format,
+        pcm.data(),
+        static_cast<int>(pcm.size()),
+        sampleRate
+    );
+    size_ = pcm.size();
+    duration_ = static_cast<double>(pcm.size() / (channels * sample_size(type))) / sampleRate;
 }
 
 Buffer::~Buffer()
@@ -42,9 +101,11 @@ Buffer::~Buffer()
     if (id_) OpenALLoader::al().alDeleteBuffers(1, &id_);
 }
 
-Buffer::Buffer(Buffer&& other) noexcept : id_(other.id_)
+Buffer::Buffer(Buffer&& other) noexcept : id_(other.id_), size_(other.size_), duration_(other.duration_)
 {
     other.id_ = 0;
+    other.size_ = 0;
+    other.duration_ = 0.0;
 }
 
 Buffer& Buffer::operator=(Buffer&& other) noexcept
@@ -53,7 +114,11 @@ Buffer& Buffer::operator=(Buffer&& other) noexcept
     {
         if (id_) OpenALLoader::al().alDeleteBuffers(1, &id_);
         id_ = other.id_;
+        size_ = other.size_;
+        duration_ = other.duration_;
         other.id_ = 0;
+        other.size_ = 0;
+        other.duration_ = 0.0;
     }
     return *this;
 }
\ No newline at end of file
@@ -0,0 +1,94 @@
+#include "buffer_cache.h"
+
+
+std::string BufferCache::make_key(const std::string& canonicalPath, bool forceMono, SampleType type)
+{
+    return canonicalPath + (forceMono ? "|mono" : "|native") + (type == SampleType::Float32 ? "|f32" : "|s16");
+}
+
+std::shared_ptr<Buffer> BufferCache::get(const std::string& path, bool forceMono, SampleType type)
+{
+    std::error_code ec;
+    std::filesystem::path canonical = std::filesystem::canonical(path, ec);
+    if (ec)
+        throw std::runtime_error("Cannot resolve audio path: " + path);
+    auto mtime = std::filesystem::last_write_time(canonical, ec);
+    std::string key = make_key(canonical.string(), forceMono, type);
+    {
+        std::lock_guard lock(mutex_);
+        auto it = entries_.find(key);
+        if (it != entries_.end() && it->second.mtime == mtime)
+        {
+            lru_.splice(lru_.begin(), lru_, it->second.lru);
+            return it->second.buffer;
+        }
+    }
+
+    // Decode outside the lock so other assets keep loading in parallel
+    auto buffer = std::make_shared<Buffer>(AudioData(canonical.string(), forceMono, type));
+
+    std::lock_guard lock(mutex_);
+    auto it = entries_.find(key);
+    if (it != entries_.end())
+    {
+        // Another thread loaded the same file meanwhile; keep whichever is current
+        if (it->second.mtime == mtime)
+        {
+            lru_.splice(lru_.begin(), lru_, it->second.lru);
+            return it->second.buffer;
+        }
+        bytes_ -= it->second.buffer->size();
+        lru_.erase(it->second.lru);
+        entries_.erase(it);
+    }
+    lru_.push_front(key);
+    entries_.emplace(key, Entry{ mtime, buffer, lru_.begin() });
+    bytes_ += buffer->size();
+    evict();
+    return buffer;
+}
+
+// Caller holds mutex_
+void BufferCache::evict()
+{
+    while (bytes_ > budget_ && !lru_.empty())
+    {
+        auto it = entries_.find(lru_.back());
+        bytes_ -= it->second.buffer->size();
+        entries_.erase(it);
+        lru_.pop_back();
+    }
+}
+
+void BufferCache::set_budget(size_t bytes)
+{
+    std::lock_guard lock(mutex_);
+    budget_ = bytes;
+    evict();
+}
+
+size_t BufferCache::get_budget()
+{
+    std::lock_guard lock(mutex_);
+    return budget_;
+}
+
+size_t BufferCache::get_bytes()
+{
+    std::lock_guard lock(mutex_);
+    return bytes_;
+}
+
+size_t BufferCache::get_count()
+{
+    std::lock_guard lock(mutex_);
+    return entries_.size();
+}
+
+void BufferCache::clear()
+{
+    std::lock_guard lock(mutex_);
+    entries_.clear();
+    lru_.clear();
+    bytes_ = 0;
+}
@@ -1,10 +1,21 @@
+#include <algorithm>
 #include "context.h"
 
 
 Context::Context(Device& device)
+{
+    create(device.handle(), nullptr);
+}
+
+Context::Context(LoopbackDevice& device)
+{
+    create(device.handle(), device.attributes());
+}
+
+void Context::create(void* device, const int* attributes)
 {
     auto& alc = OpenALLoader::alc();
-    context_ = alc.alcCreateContext(device.handle(), nullptr);
+    context_ = alc.alcCreateContext(device, attributes);
     if (!context_)
         throw std::runtime_error("Failed to create OpenAL context");
 
@@ -14,36 +25,95 @@ Context::Context(Device& device)
         context_ = nullptr;
         throw std::runtime_error("Failed to make OpenAL context current");
     }
+
+    auto& al = OpenALLoader::al();
+    deferSupported_ = al.alDeferUpdatesSOFT && al.alProcessUpdatesSOFT &&
+                      al.alIsExtensionPresent("AL_SOFT_deferred_updates");
+    live_.push_back(this);
 }
 
-Context::~Context()
+// Pooled sources belong to this context and must go before it does, even
+// when Python still holds the pool
+void Context::destroy()
 {
+    if (oneshots_)
+    {
+        oneshots_->close();
+        oneshots_.reset();
+    }
     if (context_)
     {
+        bool wasCurrent = current() == this;
+        live_.erase(std::remove(live_.begin(), live_.end(), this), live_.end());
         auto& alc = OpenALLoader::alc();
-        alc.alcMakeContextCurrent(nullptr);
+        if (wasCurrent)
+            alc.alcMakeContextCurrent(live_.empty() ? nullptr : live_.back()->context_);
         alc.alcDestroyContext(context_);
+        context_ = nullptr;
     }
 }
 
+std::shared_ptr<SourcePool> Context::oneshot_pool()
+{
+    if (!context_)
+        throw std::runtime_error("OpenAL context is not valid");
+    if (!oneshots_)
+        oneshots_ = std::make_shared<SourcePool>(oneshotVoices_);
+    return oneshots_;
+}
+
+bool Context::play_oneshot(std::shared_ptr<const Buffer> buffer, float x, float y, float z,
+                           float gain, float pitch, int priority)
+{
+    if (!oneshots_)
+        oneshot_pool();
+    return oneshots_->play_oneshot(std::move(buffer), x, y, z, gain, pitch, priority);
+}
+
+void Context::set_oneshot_voices(size_t count)
+{
+    if (count == 0)
+        throw std::runtime_error("One-shot pool needs at least one voice");
+    oneshots_.reset();
+    oneshotVoices_ = count;
+}
+
+void Context::begin_batch()
+{
+    if (batchDepth_++ == 0 && deferSupported_)
+        OpenALLoader::al().alDeferUpdatesSOFT();
+}
+
+void Context::end_batch()
+{
+    if (batchDepth_ == 0) return;
+    if (--batchDepth_ == 0 && deferSupported_)
+        OpenALLoader::al().alProcessUpdatesSOFT();
+}
+
+Context::~Context()
+{
+    destroy();
+}
+
 Context::Context(Context&& other) noexcept
 {
-    context_ = other.context_;
-    other.context_ = nullptr;
+    *this = std::move(other);
 }
 
 Context& Context::operator=(Context&& other) noexcept
 {
     if (this != &other)
     {
-        if (context_)
-        {
-            auto& alc = OpenALLoader::alc();
-            alc.alcMakeContextCurrent(nullptr);
-            alc.alcDestroyContext(context_);
-        }
+        destroy();
         context_ = other.context_;
+        batchDepth_ = other.batchDepth_;
+        deferSupported_ = other.deferSupported_;
+        oneshots_ = std::move(other.oneshots_);
+        oneshotVoices_ = other.oneshotVoices_;
+        std::replace(live_.begin(), live_.end(), &other, this);
         other.context_ = nullptr;
+        other.batchDepth_ = 0;
     }
     return *this;
-}
\ No newline at end of file
+}
@@ -0,0 +1,563 @@
+// The decoder libraries are compiled here, so the seek table pass can walk
+// MP3 frames with dr_mp3's own frame reader
+#define DR_MP3_IMPLEMENTATION
+#define DR_WAV_IMPLEMENTATION
+#include <algorithm>
+#include <cctype>
+#include <climits>
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include "decoder.h"
+#include "dr_wav.h"
+#include "dr_mp3.h"
+#include "stb_vorbis.c"
+
+
+static_assert(sizeof(SeekPoint) == sizeof(drmp3_seek_point), "SeekPoint must mirror drmp3_seek_point");
+static_assert(offsetof(SeekPoint, pcmFrameIndex) == offsetof(drmp3_seek_point, pcmFrameIndex), "SeekPoint must mirror drmp3_seek_point");
+static_assert(offsetof(SeekPoint, pcmFramesToDiscard) == offsetof(drmp3_seek_point, pcmFramesToDiscard), "SeekPoint must mirror drmp3_seek_point");
+
+constexpr char SEEK_INDEX_MAGIC[8] = { 'P', 'Y', 'A', 'L', 'S', 'E', 'E', 'K' };
+constexpr uint32_t SEEK_INDEX_VERSION = 1;
+constexpr uint32_t MAX_SEEK_POINTS = 1u << 16;
+
+// Vorbis orders surround channels FL FC FR ...; the AL multichannel formats
+// (and WAV) expect FL FR FC LFE .... Maps AL slot -> Vorbis channel.
+static const int* vorbis_channel_map(int channels)
+{
+    static const int map6[] = { 0, 2, 1, 5, 3, 4 };
+    static const int map7[] = { 0, 2, 1, 6, 5, 3, 4 };
+    static const int map8[] = { 0, 2, 1, 7, 5, 6, 3, 4 };
+    switch (channels)
+    {
+        case 6: return map6;
+        case 7: return map7;
+        case 8: return map8;
+        default: return nullptr;
+    }
+}
+
+template <typename T>
+static void reorder_vorbis_channels(T* pcm, int channels, uint64_t frames)
+{
+    const int* map = vorbis_channel_map(channels);
+    if (!map) return;
+    T frame[8];
+    for (uint64_t i = 0; i < frames; ++i)
+    {
+        T* f = pcm + i * channels;
+        std::copy(f, f + channels, frame);
+        for (int c = 0; c < channels; ++c)
+            f[c] = frame[map[c]];
+    }
+}
+
+// MPEG audio frame header: 11-bit sync, valid version, layer, bitrate and
+// sample rate fields
+static bool is_mpeg_frame_header(const uint8_t* h)
+{
+    if (h[0] != 0xFF || (h[1] & 0xE0) != 0xE0) return false;
+    if (((h[1] >> 3) & 0x03) == 0x01) return false;
+    if (((h[1] >> 1) & 0x03) == 0x00) return false;
+    if ((h[2] >> 4) == 0x0F) return false;
+    return ((h[2] >> 2) & 0x03) != 0x03;
+}
+
+AudioFormat Decoder::sniff_format(const uint8_t* header, size_t size)
+{
+    if (size >= 12 && (std::memcmp(header, "RIFF", 4) == 0 || std::memcmp(header, "RF64", 4) == 0)
+        && std::memcmp(header + 8, "WAVE", 4) == 0)
+        return AudioFormat::WAV;
+    if (size >= 4 && std::memcmp(header, "OggS", 4) == 0)
+        return AudioFormat::OGG;
+    if (size >= 3 && std::memcmp(header, "ID3", 3) == 0)
+        return AudioFormat::MP3;
+    if (size >= 4 && is_mpeg_frame_header(header))
+        return AudioFormat::MP3;
+    return AudioFormat::Unknown;
+}
+
+AudioFormat Decoder::detect_format(const std::string& path)
+{
+    uint8_t header[12] = {};
+    std::ifstream in(path, std::ios::binary);
+    if (!in) throw std::runtime_error("Failed to open audio file: " + path);
+    in.read(reinterpret_cast<char*>(header), sizeof(header));
+    AudioFormat format = sniff_format(header, static_cast<size_t>(in.gcount()));
+    return format != AudioFormat::Unknown ? format : format_from_path(path);
+}
+
+AudioFormat Decoder::format_from_path(const std::string& path)
+{
+    size_t dot = path.find_last_of('.');
+    if (dot == std::string::npos || path.size() - dot != 4) return AudioFormat::Unknown;
+    auto is = [&](const char* ext)
+    {
+        for (size_t i = 0; i < 3; ++i)
+            if (std::tolower(static_cast<unsigned char>(path[dot + 1 + i])) != ext[i]) return false;
+        return true;
+    };
+    if (is("mp3")) return AudioFormat::MP3;
+    if (is("ogg")) return AudioFormat::OGG;
+    if (is("wav")) return AudioFormat::WAV;
+    return AudioFormat::Unknown;
+}
+
+std::unique_ptr<Decoder> Decoder::open(const AssetSource& source, AudioFormat format)
+{
+    return std::make_unique<Decoder>(source, format);
+}
+
+// Byte range of a file read through stdio, exposed through the dr_wav /
+// dr_mp3 callback interface. Only the decoder touches the FILE, so its
+// position always equals base + pos between calls.
+struct FileRegion
+{
+    FILE* file = nullptr;
+    uint64_t base = 0;
+    uint64_t length = 0;
+    uint64_t pos = 0;
+
+    ~FileRegion() { if (file) fclose(file); }
+
+    static int seek_file(FILE* f, uint64_t offset)
+    {
+#ifdef _WIN32
+        return _fseeki64(f, static_cast<__int64>(offset), SEEK_SET);
+#else
+        return fseeko(f, static_cast<off_t>(offset), SEEK_SET);
+#endif
+    }
+
+    size_t read(void* out, size_t bytes)
+    {
+        bytes = static_cast<size_t>(std::min<uint64_t>(bytes, length - pos));
+        size_t n = bytes ? fread(out, 1, bytes, file) : 0;
+        pos += n;
+        return n;
+    }
+
+    bool seek(int64_t offset, int whence)
+    {
+        int64_t origin = whence == SEEK_SET ? 0 : whence == SEEK_CUR ? static_cast<int64_t>(pos) : static_cast<int64_t>(length);
+        int64_t target = origin + offset;
+        if (target < 0 || static_cast<uint64_t>(target) > length) return false;
+        if (seek_file(file, base + static_cast<uint64_t>(target)) != 0) return false;
+        pos = static_cast<uint64_t>(target);
+        return true;
+    }
+};
+
+static size_t region_read(void* user, void* out, size_t bytes)
+{
+    return static_cast<FileRegion*>(user)->read(out, bytes);
+}
+
+static drwav_bool32 region_seek_wav(void* user, int offset, drwav_seek_origin origin)
+{
+    int whence = origin == DRWAV_SEEK_SET ? SEEK_SET : origin == DRWAV_SEEK_CUR ? SEEK_CUR : SEEK_END;
+    return static_cast<FileRegion*>(user)->seek(offset, whence);
+}
+
+static drwav_bool32 region_tell_wav(void* user, drwav_int64* cursor)
+{
+    *cursor = static_cast<drwav_int64>(static_cast<FileRegion*>(user)->pos);
+    return DRWAV_TRUE;
+}
+
+static drmp3_bool32 region_seek_mp3(void* user, int offset, drmp3_seek_origin origin)
+{
+    int whence = origin == DRMP3_SEEK_SET ? SEEK_SET : origin == DRMP3_SEEK_CUR ? SEEK_CUR : SEEK_END;
+    return static_cast<FileRegion*>(user)->seek(offset, whence);
+}
+
+static drmp3_bool32 region_tell_mp3(void* user, drmp3_int64* cursor)
+{
+    *cursor = static_cast<drmp3_int64>(static_cast<FileRegion*>(user)->pos);
+    return DRMP3_TRUE;
+}
+
+// Memory sources are used as is, files are mapped when mapping is enabled
+// (regions become a span of the shared pack mapping). Otherwise whole files
+// stay with the libraries' own stdio openers and regions get a FileRegion.
+void Decoder::open_input(bool allowMapping)
+{
+    if (source_.is_memory())
+    {
+        input_ = source_.owner();
+        bytes_ = source_.data();
+        byteCount_ = static_cast<size_t>(source_.length());
+        return;
+    }
+    uint64_t offset = source_.offset();
+    if (allowMapping && get_mmap_enabled())
+    {
+        if (auto mapping = MappedFile::acquire(source_.path()))
+        {
+            uint64_t size = mapping->size();
+            uint64_t length = source_.length() ? source_.length() : size - std::min(offset, size);
+            if (offset > size || length > size - offset || length == 0)
+                throw std::runtime_error("Asset region outside pack file: " + source_.describe());
+            bytes_ = mapping->data() + offset;
+            byteCount_ = static_cast<size_t>(length);
+            input_ = std::move(mapping);
+            return;
+        }
+    }
+    if (source_.is_file()) return;
+
+    std::error_code ec;
+    uint64_t size = std::filesystem::file_size(source_.path(), ec);
+    if (ec) throw std::runtime_error("Failed to open audio file: " + source_.path());
+    uint64_t length = source_.length() ? source_.length() : size - std::min(offset, size);
+    if (offset > size || length > size - offset || length == 0)
+        throw std::runtime_error("Asset region outside pack file: " + source_.describe());
+    auto region = std::make_unique<FileRegion>();
+    region->file = fopen(source_.path().c_str(), "rb");
+    if (!region->file || FileRegion::seek_file(region->file, offset) != 0)
+        throw std::runtime_error("Failed to open audio file: " + source_.path());
+    region->base = offset;
+    region->length = length;
+    region_ = std::move(region);
+}
+
+AudioFormat Decoder::sniff_input()
+{
+    AudioFormat format = AudioFormat::Unknown;
+    if (bytes_)
+        format = sniff_format(bytes_, byteCount_);
+    else if (region_)
+    {
+        uint8_t header[12] = {};
+        size_t n = region_->read(header, sizeof(header));
+        region_->seek(0, SEEK_SET);
+        format = sniff_format(header, n);
+    }
+    else
+        return detect_format(source_.path());
+    // A pack's extension says nothing about the clip inside it
+    if (format == AudioFormat::Unknown && (source_.is_file() || source_.is_memory()))
+        format = format_from_path(source_.path());
+    return format;
+}
+
+Decoder::Decoder(const AssetSource& source, AudioFormat format)
+    : source_(source), format_(format)
+{
+    open_input(true);
+    if (format_ == AudioFormat::Unknown)
+        format_ = sniff_input();
+    const std::string name = source_.describe();
+    // stb_vorbis takes an int length; large files go through stdio instead
+    if (format_ == AudioFormat::OGG && byteCount_ > static_cast<size_t>(INT_MAX))
+    {
+        if (source_.is_memory())
+            throw std::runtime_error("OGG buffer larger than 2 GiB: " + name);
+        bytes_ = nullptr;
+        byteCount_ = 0;
+        input_.reset();
+        open_input(false);
+    }
+
+    if (format_ == AudioFormat::WAV)
+    {
+        drwav* wav = new drwav();
+        bool ok = bytes_ ? drwav_init_memory(wav, bytes_, byteCount_, nullptr)
+                : region_ ? drwav_init(wav, region_read, region_seek_wav, region_tell_wav, region_.get(), nullptr)
+                : drwav_init_file(wav, source_.path().c_str(), nullptr);
+        if (!ok)
+        {
+            delete wav;
+            throw std::runtime_error("WAV open error: " + name);
+        }
+        handle_ = wav;
+        sampleRate_ = wav->sampleRate;
+        channels_ = (uint16_t)wav->channels;
+        frameCount_ = wav->totalPCMFrameCount;
+        frameCountKnown_ = true;
+    }
+    else if (format_ == AudioFormat::MP3)
+    {
+        drmp3* mp3 = new drmp3();
+        bool ok = bytes_ ? drmp3_init_memory(mp3, bytes_, byteCount_, nullptr)
+                : region_ ? drmp3_init(mp3, region_read, region_seek_mp3, region_tell_mp3, nullptr, region_.get(), nullptr)
+                : drmp3_init_file(mp3, source_.path().c_str(), nullptr);
+        if (!ok)
+        {
+            delete mp3;
+            throw std::runtime_error("MP3 open error: " + name);
+        }
+        handle_ = mp3;
+        sampleRate_ = mp3->sampleRate;
+        channels_ = (uint16_t)mp3->channels;
+    }
+    else if (format_ == AudioFormat::OGG)
+    {
+        int err;
+        stb_vorbis* ogg = nullptr;
+        if (bytes_)
+            ogg = stb_vorbis_open_memory(bytes_, static_cast<int>(byteCount_), &err, nullptr);
+        else if (region_)
+        {
+            // stb_vorbis keeps 32-bit file offsets
+            if (region_->base + region_->length > UINT32_MAX)
+                throw std::runtime_error("OGG region beyond 4 GiB needs memory-mapped input: " + name);
+            ogg = stb_vorbis_open_file_section(region_->file, 0, &err, nullptr, static_cast<unsigned int>(region_->length));
+        }
+        else
+            ogg = stb_vorbis_open_filename(source_.path().c_str(), &err, nullptr);
+        if (!ogg) throw std::runtime_error("OGG open error: " + name);
+        handle_ = ogg;
+        stb_vorbis_info info = stb_vorbis_get_info(ogg);
+        sampleRate_ = info.sample_rate;
+        channels_ = (uint16_t)info.channels;
+        frameCount_ = stb_vorbis_stream_length_in_samples(ogg);
+        frameCountKnown_ = true;
+    }
+    else
+        throw std::runtime_error("Unsupported audio format: " + name);
+}
+
+Decoder::~Decoder()
+{
+    if (!handle_) return;
+    switch (format_)
+    {
+        case AudioFormat::WAV: drwav_uninit((drwav*)handle_); delete (drwav*)handle_; break;
+        case AudioFormat::MP3: drmp3_uninit((drmp3*)handle_); delete (drmp3*)handle_; break;
+        case AudioFormat::OGG: stb_vorbis_close((stb_vorbis*)handle_); break;
+        default: break;
+    }
+}
+
+uint64_t Decoder::frame_count()
+{
+    if (!frameCountKnown_ && format_ == AudioFormat::MP3)
+    {
+        // Header-only scan; dr_mp3 restores the read position afterwards
+        frameCount_ = drmp3_get_pcm_frame_count((drmp3*)handle_);
+        frameCountKnown_ = true;
+    }
+    return frameCount_;
+}
+
+bool Decoder::frame_count_known() const
+{
+    if (frameCountKnown_ || format_ != AudioFormat::MP3) return true;
+    return ((const drmp3*)handle_)->totalPCMFrameCount != DRMP3_UINT64_MAX;
+}
+
+uint64_t Decoder::read(int16_t* out, uint64_t frames)
+{
+    switch (format_)
+    {
+        case AudioFormat::WAV: return drwav_read_pcm_frames_s16((drwav*)handle_, frames, out);
+        case AudioFormat::MP3: return drmp3_read_pcm_frames_s16((drmp3*)handle_, frames, out);
+        case AudioFormat::OGG:
+        {
+            int request = static_cast<int>(std::min<uint64_t>(frames, INT_MAX / channels_));
+            int read = stb_vorbis_get_samples_short_interleaved((stb_vorbis*)handle_, channels_, out, request * channels_);
+            if (read <= 0) return 0;
+            reorder_vorbis_channels(out, channels_, static_cast<uint64_t>(read));
+            return static_cast<uint64_t>(read);
+        }
+        default: return 0;
+    }
+}
+
+uint64_t Decoder::read(float* out, uint64_t frames)
+{
+    switch (format_)
+    {
+        case AudioFormat::WAV: return drwav_read_pcm_frames_f32((drwav*)handle_, frames, out);
+        case AudioFormat::MP3: return drmp3_read_pcm_frames_f32((drmp3*)handle_, frames, out);
+        case AudioFormat::OGG:
+        {
+            int request = static_cast<int>(std::min<uint64_t>(frames, INT_MAX / channels_));
+            int read = stb_vorbis_get_samples_float_interleaved((stb_vorbis*)handle_, channels_, out, request * channels_);
+            if (read <= 0) return 0;
+            reorder_vorbis_channels(out, channels_, static_cast<uint64_t>(read));
+            return static_cast<uint64_t>(read);
+        }
+        default: return 0;
+    }
+}
+
+SampleType Decoder::native_sample_type() const
+{
+    if (format_ == AudioFormat::WAV)
+    {
+        const drwav* wav = (const drwav*)handle_;
+        bool wide = wav->bitsPerSample > 16 || wav->translatedFormatTag == DR_WAVE_FORMAT_IEEE_FLOAT;
+        return wide ? SampleType::Float32 : SampleType::Int16;
+    }
+    return SampleType::Float32;
+}
+
+bool Decoder::seek(uint64_t frame)
+{
+    switch (format_)
+    {
+        case AudioFormat::WAV: return drwav_seek_to_pcm_frame((drwav*)handle_, frame);
+        case AudioFormat::MP3: return drmp3_seek_to_pcm_frame((drmp3*)handle_, frame);
+        case AudioFormat::OGG:
+            if (frame == 0) return stb_vorbis_seek_start((stb_vorbis*)handle_);
+            return stb_vorbis_seek((stb_vorbis*)handle_, (unsigned int)frame);
+        default: return false;
+    }
+}
+
+// One pass over the MP3 frames that records a point every `spacing` PCM
+// frames and counts the stream on the way; drmp3_calculate_seek_points
+// needs a counting pass of its own first. Points follow dr_mp3's layout
+// (start decoding DRMP3_SEEK_LEADING_MP3_FRAMES early for the bit
+// reservoir). A full table drops every other point and doubles the spacing.
+static bool scan_seek_points(drmp3* mp3, uint64_t spacing, std::vector<SeekPoint>& points, uint64_t& totalFrames)
+{
+    constexpr uint32_t leading = DRMP3_SEEK_LEADING_MP3_FRAMES;
+    drmp3__seeking_mp3_frame_info recent[leading + 1];
+    drmp3_uint64 running = 0;
+    float fractional = 0.0f;
+    uint64_t mp3Frames = 0;
+    uint64_t nextTarget = spacing;
+    points.clear();
+    if (!drmp3_seek_to_start_of_stream(mp3)) return false;
+    for (;;)
+    {
+        drmp3__seeking_mp3_frame_info frame;
+        frame.bytePos = mp3->streamCursor - mp3->dataSize;
+        frame.pcmFrameIndex = running;
+        drmp3_uint32 pcmFrames = drmp3_decode_next_frame_ex(mp3, nullptr, nullptr, nullptr);
+        if (pcmFrames == 0) break;
+        if (mp3Frames <= leading)
+            recent[mp3Frames] = frame;
+        else
+        {
+            std::copy(recent + 1, recent + leading + 1, recent);
+            recent[leading] = frame;
+        }
+        drmp3__accumulate_running_pcm_frame_count(mp3, pcmFrames, &running, &fractional);
+        if (++mp3Frames <= leading) continue;
+
+        while (nextTarget < running)
+        {
+            if (points.size() == MAX_SEEK_POINTS)
+            {
+                // Odd entries sit on multiples of the doubled spacing
+                size_t kept = 0;
+                for (size_t i = 1; i < points.size(); i += 2)
+                    points[kept++] = points[i];
+                points.resize(kept);
+                spacing *= 2;
+                nextTarget = points.back().pcmFrameIndex + spacing;
+                continue;
+            }
+            SeekPoint point;
+            point.seekPosInBytes = recent[0].bytePos;
+            point.pcmFrameIndex = nextTarget;
+            point.mp3FramesToDiscard = leading;
+            point.pcmFramesToDiscard = static_cast<uint16_t>(nextTarget - recent[leading - 1].pcmFrameIndex);
+            points.push_back(point);
+            nextTarget += spacing;
+        }
+    }
+    if (points.empty())
+        points.push_back(SeekPoint{ 0, 0, 0, 0 });
+    totalFrames = running;
+    return drmp3_seek_to_start_of_stream(mp3);
+}
+
+size_t Decoder::build_seek_table()
+{
+    if (format_ != AudioFormat::MP3) return 0;
+    if (!seekPoints_.empty()) return seekPoints_.size();
+    drmp3* mp3 = (drmp3*)handle_;
+    // Sidecar files describe whole files, not pack regions or memory
+    bool useIndex = get_seek_index_enabled() && source_.is_file();
+    if (!(useIndex && load_seek_index()))
+    {
+        uint64_t resumeFrame = mp3->currentPCMFrame;
+        uint64_t scannedFrames = 0;
+        if (!scan_seek_points(mp3, std::max<uint64_t>(sampleRate_, 1), seekPoints_, scannedFrames))
+        {
+            seekPoints_.clear();
+            return 0;
+        }
+        // A Xing/Info count is exact (delay and padding removed), the scan
+        // only stands in when the file has none
+        if (!frame_count_known())
+        {
+            frameCount_ = scannedFrames;
+            frameCountKnown_ = true;
+        }
+        frame_count();
+        drmp3_bind_seek_table(mp3, static_cast<drmp3_uint32>(seekPoints_.size()),
+                              reinterpret_cast<drmp3_seek_point*>(seekPoints_.data()));
+        if (resumeFrame)
+            drmp3_seek_to_pcm_frame(mp3, resumeFrame);
+        if (useIndex)
+            save_seek_index();
+        return seekPoints_.size();
+    }
+    drmp3_bind_seek_table(mp3, static_cast<drmp3_uint32>(seekPoints_.size()),
+                          reinterpret_cast<drmp3_seek_point*>(seekPoints_.data()));
+    return seekPoints_.size();
+}
+
+// Index layout: magic, version, source size, source mtime, PCM frame count,
+// point count, points. Stale or foreign files are ignored.
+bool Decoder::load_seek_index()
+{
+    std::error_code ec;
+    uint64_t fileSize = std::filesystem::file_size(source_.path(), ec);
+    if (ec) return false;
+    int64_t mtime = std::filesystem::last_write_time(source_.path(), ec).time_since_epoch().count();
+    if (ec) return false;
+
+    std::ifstream in(source_.path() + ".seekidx", std::ios::binary);
+    if (!in) return false;
+    char magic[8];
+    uint32_t version = 0, count = 0;
+    uint64_t indexedSize = 0, frames = 0;
+    int64_t indexedTime = 0;
+    in.read(magic, sizeof(magic));
+    in.read(reinterpret_cast<char*>(&version), sizeof(version));
+    in.read(reinterpret_cast<char*>(&indexedSize), sizeof(indexedSize));
+    in.read(reinterpret_cast<char*>(&indexedTime), sizeof(indexedTime));
+    in.read(reinterpret_cast<char*>(&frames), sizeof(frames));
+    in.read(reinterpret_cast<char*>(&count), sizeof(count));
+    if (!in || std::memcmp(magic, SEEK_INDEX_MAGIC, sizeof(magic)) != 0 || version != SEEK_INDEX_VERSION ||
+        indexedSize != fileSize || indexedTime != mtime || count == 0 || count > MAX_SEEK_POINTS)
+        return false;
+    std::vector<SeekPoint> points(count);
+    in.read(reinterpret_cast<char*>(points.data()), static_cast<std::streamsize>(count * sizeof(SeekPoint)));
+    if (!in) return false;
+    seekPoints_ = std::move(points);
+    frameCount_ = frames;
+    frameCountKnown_ = true;
+    return true;
+}
+
+// Best effort: an unwritable location just means the table is rebuilt next time
+void Decoder::save_seek_index() const
+{
+    std::error_code ec;
+    uint64_t fileSize = std::filesystem::file_size(source_.path(), ec);
+    if (ec) return;
+    int64_t mtime = std::filesystem::last_write_time(source_.path(), ec).time_since_epoch().count();
+    if (ec) return;
+
+    std::ofstream out(source_.path() + ".seekidx", std::ios::binary | std::ios::trunc);
+    if (!out) return;
+    uint32_t count = static_cast<uint32_t>(seekPoints_.size());
+    out.write(SEEK_INDEX_MAGIC, sizeof(SEEK_INDEX_MAGIC));
+    out.write(reinterpret_cast<const char*>(&SEEK_INDEX_VERSION), sizeof(SEEK_INDEX_VERSION));
+    out.write(reinterpret_cast<const char*>(&fileSize), sizeof(fileSize));
+    out.write(reinterpret_cast<const char*>(&mtime), sizeof(mtime));
+    out.write(reinterpret_cast<const char*>(&frameCount_), sizeof(frameCount_));
+    out.write(reinterpret_cast<const char*>(&count), sizeof(count));
+    out.write(reinterpret_cast<const char*>(seekPoints_.data()), static_cast<std::streamsize>(count * sizeof(SeekPoint)));
+}
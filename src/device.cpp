@@ -1,6 +1,31 @@
 #include "device.h"
 
 
+constexpr int ALC_FREQUENCY            = 0x1007;
+constexpr int ALC_FORMAT_CHANNELS_SOFT = 0x1990;
+constexpr int ALC_FORMAT_TYPE_SOFT     = 0x1991;
+
+constexpr int ALC_MONO_SOFT    = 0x1500;
+constexpr int ALC_STEREO_SOFT  = 0x1501;
+constexpr int ALC_QUAD_SOFT    = 0x1503;
+constexpr int ALC_5POINT1_SOFT = 0x1504;
+constexpr int ALC_6POINT1_SOFT = 0x1505;
+constexpr int ALC_7POINT1_SOFT = 0x1506;
+
+static int to_alc_channels(int channels)
+{
+    switch (channels)
+    {
+        case 1: return ALC_MONO_SOFT;
+        case 2: return ALC_STEREO_SOFT;
+        case 4: return ALC_QUAD_SOFT;
+        case 6: return ALC_5POINT1_SOFT;
+        case 7: return ALC_6POINT1_SOFT;
+        case 8: return ALC_7POINT1_SOFT;
+        default: throw std::runtime_error("Unsupported loopback channel count: " + std::to_string(channels));
+    }
+}
+
 Device::Device(const std::string& name)
 {
     device_ = OpenALLoader::alc().alcOpenDevice(name.empty() ? nullptr : name.c_str());
@@ -30,4 +55,76 @@ Device& Device::operator=(Device&& other) noexcept
         other.device_ = nullptr;
     }
     return *this;
-}
\ No newline at end of file
+}
+
+LoopbackDevice::LoopbackDevice(int sampleRate, int channels, SampleType type)
+    : sampleRate_(sampleRate), channels_(channels), type_(type)
+{
+    auto& alc = OpenALLoader::alc();
+    if (!alc.alcLoopbackOpenDeviceSOFT || !alc.alcIsRenderFormatSupportedSOFT || !alc.alcRenderSamplesSOFT)
+        throw std::runtime_error("ALC_SOFT_loopback is not supported by the loaded OpenAL library");
+    if (sampleRate <= 0)
+        throw std::runtime_error("Invalid loopback sample rate: " + std::to_string(sampleRate));
+    int alcChannels = to_alc_channels(channels);
+
+    device_ = alc.alcLoopbackOpenDeviceSOFT(nullptr);
+    if (!device_)
+        throw std::runtime_error("Failed to open OpenAL loopback device");
+    if (!alc.alcIsRenderFormatSupportedSOFT(device_, sampleRate, alcChannels, static_cast<int>(type)))
+    {
+        alc.alcCloseDevice(device_);
+        device_ = nullptr;
+        throw std::runtime_error("Unsupported loopback render format");
+    }
+
+    attributes_[0] = ALC_FORMAT_CHANNELS_SOFT;
+    attributes_[1] = alcChannels;
+    attributes_[2] = ALC_FORMAT_TYPE_SOFT;
+    attributes_[3] = static_cast<int>(type);
+    attributes_[4] = ALC_FREQUENCY;
+    attributes_[5] = sampleRate;
+    attributes_[6] = 0;
+}
+
+LoopbackDevice::~LoopbackDevice()
+{
+    if (device_)
+        OpenALLoader::alc().alcCloseDevice(device_);
+}
+
+LoopbackDevice::LoopbackDevice(LoopbackDevice&& other) noexcept
+    : device_(other.device_), sampleRate_(other.sampleRate_),
+      channels_(other.channels_), type_(other.type_)
+{
+    std::copy(std::begin(other.attributes_), std::end(other.attributes_), attributes_);
+    other.device_ = nullptr;
+}
+
+LoopbackDevice& LoopbackDevice::operator=(LoopbackDevice&& other) noexcept
+{
+    if (this != &other)
+    {
+        if (device_)
+            OpenALLoader::alc().alcCloseDevice(device_);
+        device_ = other.device_;
+        sampleRate_ = other.sampleRate_;
+        channels_ = other.channels_;
+        type_ = other.type_;
+        std::copy(std::begin(other.attributes_), std::end(other.attributes_), attributes_);
+        other.device_ = nullptr;
+    }
+    return *this;
+}
+
+void LoopbackDevice::render(void* out, int frames)
+{
+    if (!device_)
+        throw std::runtime_error("Loopback device is not open");
+    if (frames <= 0) return;
+    OpenALLoader::alc().alcRenderSamplesSOFT(device_, out, frames);
+}
+
+size_t LoopbackDevice::frame_size() const
+{
+    return sample_size(type_) * static_cast<size_t>(channels_);
+}
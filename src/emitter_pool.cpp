@@ -0,0 +1,300 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include "emitter_pool.h"
+
+
+constexpr int AL_POSITION = 0x1004;
+
+// A bound emitter is only virtualized well below the bind threshold, and a
+// virtual one only takes a busy source from a clearly quieter emitter, so
+// voices near either edge do not flip every frame
+constexpr float UNBIND_FACTOR = 0.5f;
+constexpr float STEAL_MARGIN  = 1.25f;
+
+// Negative and NaN values clamp to the lowest valid one
+static float clamp_min(float value, float lowest)
+{
+    return (value >= lowest) ? value : lowest;
+}
+
+EmitterPool::EmitterPool(size_t voices, float threshold)
+    : pool_(voices), threshold_(threshold)
+{
+    candidates_.reserve(pool_.size());
+    real_.reserve(pool_.size());
+}
+
+double EmitterPool::now()
+{
+    using namespace std::chrono;
+    return duration<double>(steady_clock::now().time_since_epoch()).count();
+}
+
+EmitterPool::Emitter* EmitterPool::find(uint64_t id)
+{
+    uint32_t index = static_cast<uint32_t>(id);
+    uint32_t generation = static_cast<uint32_t>(id >> 32);
+    if (index >= emitters_.size()) return nullptr;
+    Emitter& emitter = emitters_[index];
+    if (!emitter.live || emitter.generation != generation) return nullptr;
+    return &emitter;
+}
+
+const EmitterPool::Emitter* EmitterPool::find(uint64_t id) const
+{
+    return const_cast<EmitterPool*>(this)->find(id);
+}
+
+double EmitterPool::clock(const Emitter& emitter, double time) const
+{
+    double offset = emitter.anchorOffset + (time - emitter.anchorTime) * emitter.pitch;
+    double duration = emitter.buffer->duration();
+    if (emitter.looping && duration > 0.0)
+        offset = std::fmod(offset, duration);
+    return offset;
+}
+
+void EmitterPool::rebase(Emitter& emitter, double time, double offset)
+{
+    emitter.anchorTime = time;
+    emitter.anchorOffset = offset;
+}
+
+// Gain after AL's default inverse-distance clamped model, 0 past max distance
+float EmitterPool::audibility(const Emitter& emitter, const float* listener) const
+{
+    float dx = emitter.position[0] - listener[0];
+    float dy = emitter.position[1] - listener[1];
+    float dz = emitter.position[2] - listener[2];
+    float distance = std::sqrt(dx * dx + dy * dy + dz * dz);
+    if (distance > emitter.maxDistance) return 0.0f;
+    float reference = emitter.referenceDistance;
+    if (distance <= reference || reference <= 0.0f)
+        return emitter.gain;
+    return emitter.gain * reference / (reference + emitter.rolloffFactor * (distance - reference));
+}
+
+uint64_t EmitterPool::play(std::shared_ptr<const Buffer> buffer, float x, float y, float z,
+                           float gain, float pitch, bool looping, int priority)
+{
+    if (!buffer)
+        throw std::runtime_error("EmitterPool::play needs a buffer");
+
+    uint32_t index;
+    if (free_.empty())
+    {
+        index = static_cast<uint32_t>(emitters_.size());
+        emitters_.emplace_back();
+    }
+    else
+    {
+        index = free_.back();
+        free_.pop_back();
+    }
+    Emitter& emitter = emitters_[index];
+    emitter.live = true;
+    emitter.looping = looping;
+    emitter.priority = priority;
+    emitter.buffer = std::move(buffer);
+    emitter.position[0] = x;
+    emitter.position[1] = y;
+    emitter.position[2] = z;
+    emitter.gain = clamp_min(gain, 0.0f);
+    emitter.pitch = clamp_min(pitch, 0.001f);
+    emitter.referenceDistance = 1.0f;
+    emitter.maxDistance = FLT_MAX;
+    emitter.rolloffFactor = 1.0f;
+    rebase(emitter, now(), 0.0);
+    ++live_;
+    return (static_cast<uint64_t>(emitter.generation) << 32) | index;
+}
+
+void EmitterPool::stop(uint64_t id)
+{
+    if (find(id))
+        retire(static_cast<uint32_t>(id));
+}
+
+void EmitterPool::retire(uint32_t index)
+{
+    Emitter& emitter = emitters_[index];
+    if (emitter.voice)
+        emitter.voice->stop();
+    uint32_t generation = emitter.generation + 1;
+    emitter = Emitter();
+    emitter.generation = generation;
+    free_.push_back(index);
+    --live_;
+}
+
+void EmitterPool::set_position(uint64_t id, float x, float y, float z)
+{
+    Emitter* emitter = find(id);
+    if (!emitter) return;
+    emitter->position[0] = x;
+    emitter->position[1] = y;
+    emitter->position[2] = z;
+    if (emitter->voice)
+        emitter->voice->set_position(x, y, z);
+}
+
+void EmitterPool::set_gain(uint64_t id, float gain)
+{
+    Emitter* emitter = find(id);
+    if (!emitter) return;
+    emitter->gain = clamp_min(gain, 0.0f);
+    if (emitter->voice)
+        emitter->voice->set_gain(emitter->gain);
+}
+
+void EmitterPool::set_pitch(uint64_t id, float pitch)
+{
+    Emitter* emitter = find(id);
+    if (!emitter) return;
+    double time = now();
+    rebase(*emitter, time, clock(*emitter, time));
+    emitter->pitch = clamp_min(pitch, 0.001f);
+    if (emitter->voice)
+        emitter->voice->set_pitch(emitter->pitch);
+}
+
+void EmitterPool::set_distances(uint64_t id, float referenceDistance, float maxDistance, float rolloffFactor)
+{
+    Emitter* emitter = find(id);
+    if (!emitter) return;
+    emitter->referenceDistance = clamp_min(referenceDistance, 0.0f);
+    emitter->maxDistance = clamp_min(maxDistance, 0.0f);
+    emitter->rolloffFactor = clamp_min(rolloffFactor, 0.0f);
+    if (emitter->voice)
+    {
+        emitter->voice->set_reference_distance(emitter->referenceDistance);
+        emitter->voice->set_max_distance(emitter->maxDistance);
+        emitter->voice->set_rolloff_factor(emitter->rolloffFactor);
+    }
+}
+
+bool EmitterPool::is_playing(uint64_t id) const
+{
+    const Emitter* emitter = find(id);
+    if (!emitter) return false;
+    // Same test as update(): a bound emitter plays for as long as its voice does
+    if (emitter->voice)
+        return emitter->voice->is_playing();
+    return emitter->looping || clock(*emitter, now()) < emitter->buffer->duration();
+}
+
+bool EmitterPool::is_real(uint64_t id) const
+{
+    const Emitter* emitter = find(id);
+    return emitter && emitter->voice;
+}
+
+double EmitterPool::offset(uint64_t id) const
+{
+    const Emitter* emitter = find(id);
+    if (!emitter) return 0.0;
+    if (emitter->voice)
+        return emitter->voice->offset();
+    return std::min(clock(*emitter, now()), emitter->buffer->duration());
+}
+
+void EmitterPool::bind(Emitter& emitter, double time)
+{
+    auto voice = pool_.acquire(emitter.priority);
+    if (!voice) return;
+    double offset = clock(emitter, time);
+    rebase(emitter, time, offset);
+    voice->set_buffer(emitter.buffer);
+    voice->set_looping(emitter.looping);
+    voice->set_gain(emitter.gain);
+    voice->set_pitch(emitter.pitch);
+    voice->set_position(emitter.position[0], emitter.position[1], emitter.position[2]);
+    if (emitter.referenceDistance != 1.0f) voice->set_reference_distance(emitter.referenceDistance);
+    if (emitter.maxDistance != FLT_MAX)    voice->set_max_distance(emitter.maxDistance);
+    if (emitter.rolloffFactor != 1.0f)     voice->set_rolloff_factor(emitter.rolloffFactor);
+    voice->set_offset(static_cast<float>(offset));
+    voice->play();
+    emitter.voice = voice;
+}
+
+// The mixer's own position replaces the virtual clock, so drift while bound
+// does not carry over
+void EmitterPool::unbind(Emitter& emitter, double time)
+{
+    rebase(emitter, time, emitter.voice->offset());
+    emitter.voice->stop();
+    emitter.voice.reset();
+}
+
+void EmitterPool::update()
+{
+    double time = now();
+    float listener[3] = { 0.0f, 0.0f, 0.0f };
+    OpenALLoader::al().alGetListenerfv(AL_POSITION, listener);
+
+    candidates_.clear();
+    real_.clear();
+    for (uint32_t i = 0; i < emitters_.size(); ++i)
+    {
+        Emitter& emitter = emitters_[i];
+        if (!emitter.live) continue;
+        if (!emitter.looping)
+        {
+            bool finished = emitter.voice ? !emitter.voice->is_playing()
+                                          : clock(emitter, time) >= emitter.buffer->duration();
+            if (finished)
+            {
+                retire(i);
+                continue;
+            }
+        }
+        emitter.level = audibility(emitter, listener);
+        if (emitter.voice)
+        {
+            if (emitter.level < threshold_ * UNBIND_FACTOR)
+                unbind(emitter, time);
+            else
+                real_.push_back(i);
+        }
+        else if (emitter.level >= threshold_)
+        {
+            candidates_.push_back(i);
+        }
+    }
+    if (candidates_.empty()) return;
+
+    auto louder = [this](uint32_t a, uint32_t b)
+    {
+        const Emitter& ea = emitters_[a];
+        const Emitter& eb = emitters_[b];
+        if (ea.priority != eb.priority) return ea.priority > eb.priority;
+        return ea.level > eb.level;
+    };
+    std::sort(candidates_.begin(), candidates_.end(), louder);
+
+    // Weakest bound emitters first, each one can give up its source once
+    bool sortedReal = false;
+    size_t weakest = 0;
+    for (uint32_t index : candidates_)
+    {
+        Emitter& emitter = emitters_[index];
+        if (pool_.free_count() == 0)
+        {
+            if (!sortedReal)
+            {
+                std::sort(real_.begin(), real_.end(), [&](uint32_t a, uint32_t b) { return louder(b, a); });
+                sortedReal = true;
+            }
+            if (weakest >= real_.size()) break;
+            Emitter& victim = emitters_[real_[weakest]];
+            bool wins = emitter.priority > victim.priority ||
+                        (emitter.priority == victim.priority && emitter.level > victim.level * STEAL_MARGIN);
+            // Candidates come loudest first, nobody after this one wins either
+            if (!wins) break;
+            unbind(victim, time);
+            ++weakest;
+        }
+        bind(emitter, time);
+    }
+}
@@ -0,0 +1,115 @@
+#include "mapped_file.h"
+#ifdef _WIN32
+#include "windows.h"
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+
+std::shared_ptr<const MappedFile> MappedFile::acquire(const std::string& path)
+{
+    std::error_code ec;
+    std::filesystem::path canonical = std::filesystem::canonical(path, ec);
+    if (ec) return nullptr;
+    auto mtime = std::filesystem::last_write_time(canonical, ec);
+    if (ec) return nullptr;
+    uintmax_t size = std::filesystem::file_size(canonical, ec);
+    if (ec || size == 0) return nullptr;
+
+    std::string key = canonical.string();
+    std::lock_guard lock(mutex_);
+    auto it = mappings_.find(key);
+    if (it != mappings_.end())
+    {
+        // A rewritten file gets a fresh view; decoders on the old one keep it alive
+        auto existing = it->second.lock();
+        if (existing && existing->mtime_ == mtime && existing->size_ == size)
+            return existing;
+    }
+
+    std::shared_ptr<MappedFile> mapped(new MappedFile());
+    mapped->mtime_ = mtime;
+    if (!mapped->map(key))
+        return nullptr;
+    mappings_[key] = mapped;
+
+    // Drop registry slots whose views have all been released
+    for (auto slot = mappings_.begin(); slot != mappings_.end();)
+        slot = slot->second.expired() ? mappings_.erase(slot) : std::next(slot);
+    return mapped;
+}
+
+#ifdef _WIN32
+
+bool MappedFile::map(const std::string& path)
+{
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                              FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (file == INVALID_HANDLE_VALUE) return false;
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file, &size) || size.QuadPart == 0)
+    {
+        CloseHandle(file);
+        return false;
+    }
+    HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (!mapping)
+    {
+        CloseHandle(file);
+        return false;
+    }
+    void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    if (!view)
+    {
+        CloseHandle(mapping);
+        CloseHandle(file);
+        return false;
+    }
+    file_ = file;
+    mapping_ = mapping;
+    data_ = static_cast<const uint8_t*>(view);
+    size_ = static_cast<size_t>(size.QuadPart);
+    return true;
+}
+
+MappedFile::~MappedFile()
+{
+    if (data_) UnmapViewOfFile(data_);
+    if (mapping_) CloseHandle(mapping_);
+    if (file_) CloseHandle(file_);
+}
+
+#else
+
+bool MappedFile::map(const std::string& path)
+{
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return false;
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size <= 0)
+    {
+        ::close(fd);
+        return false;
+    }
+    size_t size = static_cast<size_t>(st.st_size);
+    void* view = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+    // The mapping keeps its own reference to the file
+    ::close(fd);
+    if (view == MAP_FAILED) return false;
+#ifdef MADV_SEQUENTIAL
+    madvise(view, size, MADV_SEQUENTIAL);
+#endif
+    data_ = static_cast<const uint8_t*>(view);
+    size_ = size;
+    return true;
+}
+
+MappedFile::~MappedFile()
+{
+    if (data_) munmap(const_cast<uint8_t*>(data_), size_);
+}
+
+#endif
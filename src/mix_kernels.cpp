@@ -0,0 +1,297 @@
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include "mix_kernels.h"
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define MIX_X86 1
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#define MIX_TARGET_AVX2
+#else
+#define MIX_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#elif defined(__aarch64__) || defined(_M_ARM64) || defined(__ARM_NEON)
+#define MIX_NEON 1
+#include <arm_neon.h>
+#endif
+
+
+// The widest layout AL can play (7.1)
+constexpr uint16_t MAX_REMIX_OUTPUTS = 8;
+
+using StereoToMonoS16 = void (*)(const int16_t*, int16_t*, size_t);
+using StereoToMonoF32 = void (*)(const float*, float*, size_t);
+
+struct MixKernels
+{
+    const char* name;
+    StereoToMonoS16 stereoS16;
+    StereoToMonoF32 stereoF32;
+};
+
+// Scalar reference versions; the vector kernels finish their tails with these.
+// Integer averages round towards negative infinity, like the SIMD shifts.
+static void stereo_to_mono_s16_scalar(const int16_t* in, int16_t* out, size_t frames)
+{
+    for (size_t i = 0; i < frames; ++i)
+        out[i] = static_cast<int16_t>((static_cast<int32_t>(in[i * 2]) + in[i * 2 + 1]) >> 1);
+}
+
+static void stereo_to_mono_f32_scalar(const float* in, float* out, size_t frames)
+{
+    for (size_t i = 0; i < frames; ++i)
+        out[i] = (in[i * 2] + in[i * 2 + 1]) * 0.5f;
+}
+
+#ifdef MIX_X86
+static void stereo_to_mono_s16_sse2(const int16_t* in, int16_t* out, size_t frames)
+{
+    const __m128i ones = _mm_set1_epi16(1);
+    size_t i = 0;
+    for (; i + 8 <= frames; i += 8)
+    {
+        __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i * 2));
+        __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i * 2 + 8));
+        // madd against ones sums each L/R pair into 32 bits
+        __m128i sa = _mm_srai_epi32(_mm_madd_epi16(a, ones), 1);
+        __m128i sb = _mm_srai_epi32(_mm_madd_epi16(b, ones), 1);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), _mm_packs_epi32(sa, sb));
+    }
+    stereo_to_mono_s16_scalar(in + i * 2, out + i, frames - i);
+}
+
+static void stereo_to_mono_f32_sse2(const float* in, float* out, size_t frames)
+{
+    const __m128 half = _mm_set1_ps(0.5f);
+    size_t i = 0;
+    for (; i + 4 <= frames; i += 4)
+    {
+        __m128 a = _mm_loadu_ps(in + i * 2);
+        __m128 b = _mm_loadu_ps(in + i * 2 + 4);
+        __m128 left = _mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0));
+        __m128 right = _mm_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1));
+        _mm_storeu_ps(out + i, _mm_mul_ps(_mm_add_ps(left, right), half));
+    }
+    stereo_to_mono_f32_scalar(in + i * 2, out + i, frames - i);
+}
+
+MIX_TARGET_AVX2
+static void stereo_to_mono_s16_avx2(const int16_t* in, int16_t* out, size_t frames)
+{
+    const __m256i ones = _mm256_set1_epi16(1);
+    size_t i = 0;
+    for (; i + 16 <= frames; i += 16)
+    {
+        __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + i * 2));
+        __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + i * 2 + 16));
+        __m256i sa = _mm256_srai_epi32(_mm256_madd_epi16(a, ones), 1);
+        __m256i sb = _mm256_srai_epi32(_mm256_madd_epi16(b, ones), 1);
+        // packs works per 128-bit lane, restore frame order across lanes
+        __m256i packed = _mm256_permute4x64_epi64(_mm256_packs_epi32(sa, sb), 0xD8);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), packed);
+    }
+    stereo_to_mono_s16_sse2(in + i * 2, out + i, frames - i);
+}
+
+MIX_TARGET_AVX2
+static void stereo_to_mono_f32_avx2(const float* in, float* out, size_t frames)
+{
+    const __m256 half = _mm256_set1_ps(0.5f);
+    size_t i = 0;
+    for (; i + 8 <= frames; i += 8)
+    {
+        __m256 a = _mm256_loadu_ps(in + i * 2);
+        __m256 b = _mm256_loadu_ps(in + i * 2 + 8);
+        __m256 left = _mm256_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0));
+        __m256 right = _mm256_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1));
+        __m256 mono = _mm256_mul_ps(_mm256_add_ps(left, right), half);
+        mono = _mm256_castpd_ps(_mm256_permute4x64_pd(_mm256_castps_pd(mono), 0xD8));
+        _mm256_storeu_ps(out + i, mono);
+    }
+    stereo_to_mono_f32_sse2(in + i * 2, out + i, frames - i);
+}
+
+static bool cpu_has_avx2()
+{
+#ifdef _MSC_VER
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] < 7) return false;
+    __cpuid(info, 1);
+    bool osxsave = (info[2] & (1 << 27)) != 0;
+    bool avx = (info[2] & (1 << 28)) != 0;
+    if (!osxsave || !avx || (_xgetbv(0) & 0x6) != 0x6) return false;
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 5)) != 0;
+#else
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2");
+#endif
+}
+#endif
+
+#ifdef MIX_NEON
+static void stereo_to_mono_s16_neon(const int16_t* in, int16_t* out, size_t frames)
+{
+    size_t i = 0;
+    for (; i + 8 <= frames; i += 8)
+    {
+        int16x8x2_t lr = vld2q_s16(in + i * 2);
+        vst1q_s16(out + i, vhaddq_s16(lr.val[0], lr.val[1]));
+    }
+    stereo_to_mono_s16_scalar(in + i * 2, out + i, frames - i);
+}
+
+static void stereo_to_mono_f32_neon(const float* in, float* out, size_t frames)
+{
+    const float32x4_t half = vdupq_n_f32(0.5f);
+    size_t i = 0;
+    for (; i + 4 <= frames; i += 4)
+    {
+        float32x4x2_t lr = vld2q_f32(in + i * 2);
+        vst1q_f32(out + i, vmulq_f32(vaddq_f32(lr.val[0], lr.val[1]), half));
+    }
+    stereo_to_mono_f32_scalar(in + i * 2, out + i, frames - i);
+}
+#endif
+
+static MixKernels select_kernels()
+{
+#if defined(MIX_X86)
+    if (cpu_has_avx2())
+        return { "avx2", stereo_to_mono_s16_avx2, stereo_to_mono_f32_avx2 };
+    return { "sse2", stereo_to_mono_s16_sse2, stereo_to_mono_f32_sse2 };
+#elif defined(MIX_NEON)
+    return { "neon", stereo_to_mono_s16_neon, stereo_to_mono_f32_neon };
+#else
+    return { "scalar", stereo_to_mono_s16_scalar, stereo_to_mono_f32_scalar };
+#endif
+}
+
+static const MixKernels& kernels()
+{
+    static const MixKernels selected = select_kernels();
+    return selected;
+}
+
+const char* mix_kernel_name()
+{
+    return kernels().name;
+}
+
+std::vector<float> mono_downmix_weights(uint16_t channels)
+{
+    constexpr float centre = 1.41421356f;
+    constexpr float surround = 0.70710678f;
+    std::vector<float> weights;
+    switch (channels)
+    {
+        case 1: weights = { 1.0f }; break;
+        case 2: weights = { 1.0f, 1.0f }; break;
+        case 4: weights = { 1.0f, 1.0f, surround, surround }; break;
+        case 6: weights = { 1.0f, 1.0f, centre, 0.0f, surround, surround }; break;
+        case 7: weights = { 1.0f, 1.0f, centre, 0.0f, surround, surround, surround }; break;
+        case 8: weights = { 1.0f, 1.0f, centre, 0.0f, surround, surround, surround, surround }; break;
+        default: weights.assign(channels, 1.0f); break;
+    }
+    float total = 0.0f;
+    for (float w : weights) total += w;
+    for (float& w : weights) w /= total;
+    return weights;
+}
+
+// Weights for every layout AL can play, built once so that streaming
+// refills do not allocate
+static const float* cached_mono_weights(uint16_t channels)
+{
+    static const auto tables = []
+    {
+        std::array<std::array<float, 8>, 9> rows{};
+        for (uint16_t c = 1; c <= 8; ++c)
+        {
+            std::vector<float> weights = mono_downmix_weights(c);
+            std::copy(weights.begin(), weights.end(), rows[c].begin());
+        }
+        return rows;
+    }();
+    return tables[channels].data();
+}
+
+// Scalar. Each frame is read completely before its outputs are written,
+// which is what makes in-place use safe when the output has no more channels
+template <typename T>
+static void remix_frames(const T* in, uint16_t inChannels, T* out, uint16_t outChannels,
+                         const float* matrix, size_t frames)
+{
+    if (outChannels > MAX_REMIX_OUTPUTS)
+        throw std::runtime_error("Remix supports at most " + std::to_string(MAX_REMIX_OUTPUTS) +
+                                 " output channels, got " + std::to_string(outChannels));
+    float acc[MAX_REMIX_OUTPUTS];
+    for (size_t f = 0; f < frames; ++f)
+    {
+        const T* src = in + f * inChannels;
+        for (uint16_t o = 0; o < outChannels; ++o)
+        {
+            const float* row = matrix + o * inChannels;
+            float sum = 0.0f;
+            for (uint16_t c = 0; c < inChannels; ++c)
+                sum += static_cast<float>(src[c]) * row[c];
+            acc[o] = sum;
+        }
+        T* dst = out + f * outChannels;
+        for (uint16_t o = 0; o < outChannels; ++o)
+        {
+            if constexpr (std::is_floating_point_v<T>)
+                dst[o] = acc[o];
+            else
+                dst[o] = static_cast<T>(std::clamp(std::lround(acc[o]), -32768L, 32767L));
+        }
+    }
+}
+
+void remix(const int16_t* in, uint16_t inChannels, int16_t* out, uint16_t outChannels,
+           const float* matrix, size_t frames)
+{
+    remix_frames(in, inChannels, out, outChannels, matrix, frames);
+}
+
+void remix(const float* in, uint16_t inChannels, float* out, uint16_t outChannels,
+           const float* matrix, size_t frames)
+{
+    remix_frames(in, inChannels, out, outChannels, matrix, frames);
+}
+
+void downmix_mono(const int16_t* in, int16_t* out, uint16_t channels, size_t frames)
+{
+    if (channels == 2)
+        return kernels().stereoS16(in, out, frames);
+    if (channels == 1)
+    {
+        if (in != out) std::copy(in, in + frames, out);
+        return;
+    }
+    if (channels <= 8)
+        return remix(in, channels, out, 1, cached_mono_weights(channels), frames);
+    std::vector<float> weights = mono_downmix_weights(channels);
+    remix(in, channels, out, 1, weights.data(), frames);
+}
+
+void downmix_mono(const float* in, float* out, uint16_t channels, size_t frames)
+{
+    if (channels == 2)
+        return kernels().stereoF32(in, out, frames);
+    if (channels == 1)
+    {
+        if (in != out) std::copy(in, in + frames, out);
+        return;
+    }
+    if (channels <= 8)
+        return remix(in, channels, out, 1, cached_mono_weights(channels), frames);
+    std::vector<float> weights = mono_downmix_weights(channels);
+    remix(in, channels, out, 1, weights.data(), frames);
+}
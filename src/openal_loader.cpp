@@ -4,7 +4,9 @@
 static ALCFunctions alc_;
 static ALFunctions al_;
 std::mutex OpenALLoader::mutex_;
-HMODULE OpenALLoader::lib_handle_ = nullptr;
+LibraryHandle OpenALLoader::lib_handle_ = nullptr;
+
+#ifdef _WIN32
 
 std::string get_default_library_path() 
 {
@@ -21,11 +23,11 @@ std::string get_default_library_path()
     return (module_path / dll_subpath).string();
 }
 
-bool OpenALLoader::load_library(const std::string& path) 
+static LibraryHandle open_library(const std::string& path)
 {
     std::string abs_path = std::filesystem::absolute(path).string();
-    lib_handle_ = LoadLibraryA(abs_path.c_str());
-    if (!lib_handle_)
+    LibraryHandle handle = LoadLibraryA(abs_path.c_str());
+    if (!handle)
     {
         DWORD err = GetLastError();
         std::ostringstream oss;
@@ -42,11 +44,86 @@ bool OpenALLoader::load_library(const std::string& path)
         }
         throw std::runtime_error(oss.str());
     }
+    return handle;
+}
+
+static void* get_symbol(LibraryHandle lib, const char* name)
+{
+    return reinterpret_cast<void*>(GetProcAddress(lib, name));
+}
+
+static void close_library(LibraryHandle lib)
+{
+    FreeLibrary(lib);
+}
+
+#else
+
+// Search order: a copy shipped next to the module (Linux64/ subfolder first,
+// mirroring the Win64/ layout, then the module folder itself), and finally
+// the bare soname so that dlopen walks the system library paths.
+std::string get_default_library_path()
+{
+    constexpr const char* soname = "libopenal.so.1";
+    Dl_info info;
+    if (dladdr(reinterpret_cast<void*>(&get_default_library_path), &info) && info.dli_fname)
+    {
+        std::filesystem::path module_path = std::filesystem::path(info.dli_fname).parent_path();
+        std::filesystem::path arch_dir = (sizeof(void*) == 8) ? "Linux64" : "Linux32";
+        std::error_code ec;
+        for (const auto& candidate : { module_path / arch_dir / soname, module_path / soname })
+        {
+            if (std::filesystem::exists(candidate, ec))
+                return candidate.string();
+        }
+    }
+    return soname;
+}
+
+static LibraryHandle open_library(const std::string& path)
+{
+    // A bare file name is handed to dlopen as-is so it searches the system paths
+    bool bare = std::filesystem::path(path).parent_path().empty();
+    std::string load_path = bare ? path : std::filesystem::absolute(path).string();
+    LibraryHandle handle = dlopen(load_path.c_str(), RTLD_NOW | RTLD_LOCAL);
+    if (!handle)
+    {
+        const char* err = dlerror();
+        std::ostringstream oss;
+        oss << "Failed to load OpenAL library at: " << load_path << "\n"
+            << "Error: " << (err ? err : "unknown dlopen error");
+        throw std::runtime_error(oss.str());
+    }
+    return handle;
+}
+
+static void* get_symbol(LibraryHandle lib, const char* name)
+{
+    return dlsym(lib, name);
+}
+
+static void close_library(LibraryHandle lib)
+{
+    dlclose(lib);
+}
+
+#endif
+
+bool OpenALLoader::load_library(const std::string& path) 
+{
+    lib_handle_ = open_library(path);
 
     #define LOAD_PROC(lib, name, target) \
-        target.name = reinterpret_cast<decltype(target.name)>(GetProcAddress(lib, #name)); \
+        target.name = reinterpret_cast<decltype(target.name)>(get_symbol(lib, #name)); \
         if (!target.name) success = false;
 
+    // Extension entry points are not required; prefer the exported symbol and
+    // fall back to alcGetProcAddress for implementations that do not export them
+    #define LOAD_EXT_PROC(lib, name, target) \
+        target.name = reinterpret_cast<decltype(target.name)>(get_symbol(lib, #name)); \
+        if (!target.name && alc_.alcGetProcAddress) \
+            target.name = reinterpret_cast<decltype(target.name)>(alc_.alcGetProcAddress(nullptr, #name));
+
     bool success = true;
 
     // Load ALC functions
@@ -55,6 +132,13 @@ bool OpenALLoader::load_library(const std::string& path)
     LOAD_PROC(lib_handle_, alcCreateContext, alc_);
     LOAD_PROC(lib_handle_, alcDestroyContext, alc_);
     LOAD_PROC(lib_handle_, alcMakeContextCurrent, alc_);
+    LOAD_PROC(lib_handle_, alcIsExtensionPresent, alc_);
+    LOAD_PROC(lib_handle_, alcGetProcAddress, alc_);
+
+    // Load ALC extension functions
+    LOAD_EXT_PROC(lib_handle_, alcLoopbackOpenDeviceSOFT, alc_);
+    LOAD_EXT_PROC(lib_handle_, alcIsRenderFormatSupportedSOFT, alc_);
+    LOAD_EXT_PROC(lib_handle_, alcRenderSamplesSOFT, alc_);
 
     // Load AL Buffer functions
     LOAD_PROC(lib_handle_, alGenBuffers, al_);
@@ -73,6 +157,9 @@ bool OpenALLoader::load_library(const std::string& path)
     LOAD_PROC(lib_handle_, alSourceStop, al_);
     LOAD_PROC(lib_handle_, alSourcePause, al_);
     LOAD_PROC(lib_handle_, alSourceRewind, al_);
+    LOAD_PROC(lib_handle_, alSourcePlayv, al_);
+    LOAD_PROC(lib_handle_, alSourceStopv, al_);
+    LOAD_PROC(lib_handle_, alSourcePausev, al_);
     LOAD_PROC(lib_handle_, alSourceQueueBuffers, al_);
     LOAD_PROC(lib_handle_, alSourceUnqueueBuffers, al_);
 
@@ -84,14 +171,21 @@ bool OpenALLoader::load_library(const std::string& path)
     LOAD_PROC(lib_handle_, alGetListenerfv, al_);
 
     // Load AL Other functions
+    // AL_SOFT_deferred_updates
+    LOAD_EXT_PROC(lib_handle_, alDeferUpdatesSOFT, al_);
+    LOAD_EXT_PROC(lib_handle_, alProcessUpdatesSOFT, al_);
+
     LOAD_PROC(lib_handle_, alDistanceModel, al_);
     LOAD_PROC(lib_handle_, alGetInteger, al_);
+    LOAD_PROC(lib_handle_, alIsExtensionPresent, al_);
+    LOAD_PROC(lib_handle_, alGetEnumValue, al_);
 
     #undef LOAD_PROC
+    #undef LOAD_EXT_PROC
 
     if (!success)
     {
-        FreeLibrary(lib_handle_);
+        close_library(lib_handle_);
         lib_handle_ = nullptr;
         return false;
     }
@@ -130,7 +224,7 @@ void OpenALLoader::shutdown()
     if (!initialized_) return;
     if (lib_handle_)
     {
-        FreeLibrary(lib_handle_);
+        close_library(lib_handle_);
         lib_handle_ = nullptr;
     }
     initialized_ = false;
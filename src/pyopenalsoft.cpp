@@ -7,49 +7,332 @@
 #include "device.h"
 #include "context.h"
 #include "buffer.h"
+#include "buffer_cache.h"
+#include "batch_loader.h"
 #include "source.h"
+#include "source_pool.h"
+#include "source_group.h"
+#include "emitter_pool.h"
 #include "listener.h"
 #include "stream.h"
+#include "stream_worker.h"
+#include "decoder.h"
+#include "asset_source.h"
+#include "mix_kernels.h"
 
 
 namespace py = pybind11;
 
+static bool is_c_contiguous(const py::buffer_info& info)
+{
+    py::ssize_t expected = info.itemsize;
+    for (py::ssize_t i = info.ndim - 1; i >= 0; --i)
+    {
+        if (info.shape[i] > 1 && info.strides[i] != expected)
+            return false;
+        expected *= info.shape[i];
+    }
+    return true;
+}
+
+// Request a writable view of a buffer-protocol object and make sure its memory is contiguous
+static py::buffer_info request_writable(const py::buffer& buffer)
+{
+    py::buffer_info info = buffer.request(true);
+    if (!is_c_contiguous(info))
+        throw std::runtime_error("Output buffer must be C-contiguous");
+    return info;
+}
+
+// Hand `rows` x `columns` floats to `apply`. Contiguous float32 buffers
+// (e.g. numpy arrays) are passed through as is; float64 buffers and plain
+// sequences of numbers or (x, y, z) tuples are converted first.
+template <typename Apply>
+static void with_float_rows(const py::object& data, size_t rows, size_t columns, Apply&& apply)
+{
+    std::vector<float> converted;
+    converted.reserve(rows * columns);
+    if (py::isinstance<py::buffer>(data))
+    {
+        py::buffer_info info = py::reinterpret_borrow<py::buffer>(data).request();
+        if (static_cast<size_t>(info.size) != rows * columns || !is_c_contiguous(info))
+            throw std::runtime_error("Expected a contiguous array of " + std::to_string(rows) + " x " + std::to_string(columns) + " values");
+        if (info.format == py::format_descriptor<float>::format())
+            return apply(static_cast<const float*>(info.ptr));
+        if (info.format != py::format_descriptor<double>::format())
+            throw std::runtime_error("Array must hold float32 or float64 values");
+        const double* values = static_cast<const double*>(info.ptr);
+        converted.assign(values, values + rows * columns);
+        return apply(converted.data());
+    }
+    for (py::handle row : data)
+    {
+        if (columns == 1)
+            converted.push_back(row.cast<float>());
+        else
+            for (py::handle value : row)
+                converted.push_back(value.cast<float>());
+    }
+    if (converted.size() != rows * columns)
+        throw std::runtime_error("Expected " + std::to_string(rows) + " x " + std::to_string(columns) + " values");
+    apply(converted.data());
+}
+
+// Zero-copy AssetSource over a buffer-protocol object (bytes, bytearray,
+// memoryview, ...). The owner holds the exported view, which keeps the object
+// alive and locked against resizing until the last decoder lets go. Decoders
+// can be dropped on threads without the GIL, so the release re-acquires it.
+static AssetSource source_from_buffer(const py::buffer& buffer, const std::string& name)
+{
+    auto view = new Py_buffer();
+    if (PyObject_GetBuffer(buffer.ptr(), view, PyBUF_SIMPLE) != 0)
+    {
+        delete view;
+        throw py::error_already_set();
+    }
+    std::shared_ptr<const void> owner(view, [](Py_buffer* v)
+    {
+        if (Py_IsInitialized())
+        {
+            py::gil_scoped_acquire gil;
+            PyBuffer_Release(v);
+        }
+        delete v;
+    });
+    return AssetSource::memory(view->buf, static_cast<size_t>(view->len), std::move(owner), name);
+}
+
+// `with context.batch():` scope over Context::begin_batch / end_batch
+struct ContextBatch
+{
+    Context* context;
+};
+
 PYBIND11_MODULE(pyopenalsoft, m) {
     m.def("init", [](const std::optional<std::string>& path) 
         { OpenALLoader::init(path.value_or("")); },
           py::arg("path") = py::none());
-    m.def("shutdown", &OpenALLoader::shutdown);
+    // Stream threads must be joined and cached buffers released while the
+    // library is still loaded
+    m.def("shutdown", []()
+        {
+            StreamWorker::shutdown();
+            BufferCache::clear();
+            OpenALLoader::shutdown();
+        }, py::call_guard<py::gil_scoped_release>());
+    py::module_::import("atexit").attr("register")(py::cpp_function([]()
+        {
+            StreamWorker::shutdown();
+            BufferCache::clear();
+        }, py::call_guard<py::gil_scoped_release>()));
     m.def("get_dll_path", &OpenALLoader::get_dll_path);
+    m.def("set_mp3_seek_index", &Decoder::set_seek_index_enabled, py::arg("enabled"));
+    m.def("get_mp3_seek_index", &Decoder::get_seek_index_enabled);
+    // Off by default: a mapped asset truncated on disk while decoding kills the process
+    m.def("set_mmap_input", &Decoder::set_mmap_enabled, py::arg("enabled"));
+    m.def("get_mmap_input", &Decoder::get_mmap_enabled);
+    m.def("get_mix_kernel", &mix_kernel_name);
 
     py::class_<Device>(m, "Device")
         .def(py::init<const std::string&>(),
              py::arg("name") = "");
 
+    py::enum_<SampleType>(m, "SampleType")
+        .value("INT16", SampleType::Int16)
+        .value("FLOAT32", SampleType::Float32)
+        .export_values();
+
+    py::enum_<AudioFormat>(m, "AudioFormat")
+        .value("MP3", AudioFormat::MP3)
+        .value("OGG", AudioFormat::OGG)
+        .value("WAV", AudioFormat::WAV)
+        .value("UNKNOWN", AudioFormat::Unknown);
+
+    m.def("detect_format", &Decoder::detect_format, py::arg("path"));
+
+    py::class_<LoopbackDevice>(m, "LoopbackDevice")
+        .def(py::init<int, int, SampleType>(),
+             py::arg("sample_rate") = 44100,
+             py::arg("channels") = 2,
+             py::arg("sample_type") = SampleType::Int16)
+        .def_property_readonly("sample_rate", &LoopbackDevice::sample_rate)
+        .def_property_readonly("channels", &LoopbackDevice::channels)
+        .def_property_readonly("sample_type", &LoopbackDevice::sample_type)
+        .def_property_readonly("frame_size", &LoopbackDevice::frame_size)
+        // Render into a caller-provided writable buffer, returns the frames rendered
+        .def("render", [](LoopbackDevice& d, py::buffer out, std::optional<int> frames)
+        {
+            py::buffer_info info = request_writable(out);
+            size_t capacity = static_cast<size_t>(info.size * info.itemsize) / d.frame_size();
+            int count = frames.value_or(static_cast<int>(capacity));
+            if (count < 0 || static_cast<size_t>(count) > capacity)
+                throw std::runtime_error("Output buffer too small for requested frames");
+            py::gil_scoped_release release;
+            d.render(info.ptr, count);
+            return count;
+        }, py::arg("out"), py::arg("frames") = py::none())
+        .def("render", [](LoopbackDevice& d, int frames)
+        {
+            if (frames < 0)
+                throw std::runtime_error("Frame count must be non-negative");
+            size_t size = static_cast<size_t>(frames) * d.frame_size();
+            py::bytes out(nullptr, size);
+            char* dst = PyBytes_AsString(out.ptr());
+            {
+                py::gil_scoped_release release;
+                d.render(dst, frames);
+            }
+            return out;
+        }, py::arg("frames"));
+
+    py::class_<ContextBatch>(m, "ContextBatch")
+        .def("__enter__", [](ContextBatch& b) { b.context->begin_batch(); return b; })
+        .def("__exit__", [](ContextBatch& b, py::args) { b.context->end_batch(); });
+
     py::class_<Context>(m, "Context")
-        .def(py::init<Device&>());
+        .def(py::init<Device&>())
+        .def(py::init<LoopbackDevice&>())
+        // Defers listener/source changes until the with-block exits
+        .def("batch", [](Context& c) { return ContextBatch{ &c }; }, py::keep_alive<0, 1>())
+        .def_property_readonly("in_batch", &Context::in_batch)
+        .def_property_readonly("deferred_updates_supported", &Context::deferred_updates_supported)
+        .def("play_oneshot", [](Context& c, std::shared_ptr<const Buffer> buffer, const std::array<float, 3>& position,
+                                float gain, float pitch, int priority)
+            {
+                return c.play_oneshot(std::move(buffer), position[0], position[1], position[2], gain, pitch, priority);
+            }, py::arg("buffer"), py::arg("position") = std::array<float, 3>{ 0.0f, 0.0f, 0.0f },
+               py::arg("gain") = 1.0f, py::arg("pitch") = 1.0f, py::arg("priority") = 0)
+        .def_property("oneshot_voices", &Context::oneshot_voices, &Context::set_oneshot_voices)
+        .def_property_readonly("oneshot_pool", &Context::oneshot_pool);
+
+    // One-shot on the current context, the newest one still alive
+    m.def("play_oneshot", [](std::shared_ptr<const Buffer> buffer, const std::array<float, 3>& position,
+                             float gain, float pitch, int priority)
+        {
+            Context* context = Context::current();
+            if (!context)
+                throw std::runtime_error("No current OpenAL context");
+            return context->play_oneshot(std::move(buffer), position[0], position[1], position[2], gain, pitch, priority);
+        }, py::arg("buffer"), py::arg("position") = std::array<float, 3>{ 0.0f, 0.0f, 0.0f },
+           py::arg("gain") = 1.0f, py::arg("pitch") = 1.0f, py::arg("priority") = 0);
+
+    // Owns the decoded samples; memoryview(pcm) / numpy.asarray(pcm) share its memory
+    py::class_<PCMData>(m, "PCMData", py::buffer_protocol())
+        .def_buffer([](PCMData& p) -> py::buffer_info
+        {
+            bool isFloat = p.sampleType == SampleType::Float32;
+            py::ssize_t itemSize = static_cast<py::ssize_t>(sample_size(p.sampleType));
+            return py::buffer_info(
+                p.data.data(),
+                itemSize,
+                isFloat ? py::format_descriptor<float>::format() : py::format_descriptor<int16_t>::format(),
+                2,
+                { static_cast<py::ssize_t>(p.frames()), static_cast<py::ssize_t>(p.channels) },
+                { static_cast<py::ssize_t>(p.channels) * itemSize, itemSize }
+            );
+        })
+        .def_property_readonly("frames", &PCMData::frames)
+        .def_property_readonly("channels", [](const PCMData& p) { return p.channels; })
+        .def_property_readonly("sample_rate", [](const PCMData& p) { return p.sampleRate; })
+        .def_property_readonly("sample_type", [](const PCMData& p) { return p.sampleType; })
+        .def_property_readonly("nbytes", [](const PCMData& p) { return p.data.size(); })
+        .def("__len__", &PCMData::frames)
+        .def("tobytes", [](const PCMData& p)
+        {
+            return py::bytes(reinterpret_cast<const char*>(p.data.data()), p.data.size());
+        });
+
+    // A file, a clip inside a pack file or in-memory bytes. Path strings and
+    // buffer-protocol objects convert implicitly wherever a source is taken.
+    // The buffer overload comes first so bytes are never taken for a path.
+    py::class_<AssetSource>(m, "AssetSource")
+        .def(py::init([](const py::buffer& data, const std::string& name) { return source_from_buffer(data, name); }),
+             py::arg("data"), py::arg("name") = "<memory>")
+        .def(py::init<const std::string&>(), py::arg("path"))
+        .def_static("region", &AssetSource::region,
+                    py::arg("pack"), py::arg("offset"), py::arg("length") = 0)
+        .def_property_readonly("path", &AssetSource::path)
+        .def_property_readonly("offset", &AssetSource::offset)
+        .def_property_readonly("length", &AssetSource::length)
+        .def_property_readonly("in_memory", &AssetSource::is_memory)
+        .def("__repr__", [](const AssetSource& s) { return "<AssetSource " + s.describe() + ">"; });
+    py::implicitly_convertible<py::buffer, AssetSource>();
+    py::implicitly_convertible<std::string, AssetSource>();
 
     // Note: forceMono abstracted as surround. If surround, we forcibly convert to mono.
     py::class_<AudioData>(m, "AudioData")
-        .def(py::init<const std::string&, bool>(), 
+        // sample_type=None decodes at the source's native precision; path also
+        // takes an AssetSource or a bytes-like object (decoded without a copy)
+        .def(py::init<const AssetSource&, bool, std::optional<SampleType>>(), 
             py::arg("path"), 
-            py::arg("surround") = false)
+            py::arg("surround") = false,
+            py::arg("sample_type") = SampleType::Int16,
+            py::call_guard<py::gil_scoped_release>())
         .def_property_readonly("sample_rate", [](const AudioData& a) { return a.sampleRate; })
         .def_property_readonly("channels", [](const AudioData& a) { return a.channels; })
         .def_property_readonly("bits_per_sample", [](const AudioData& a) { return a.bitsPerSample; })
         .def_property_readonly("bytes_per_sample", [](const AudioData& a) { return a.bytesPerSample; })
+        .def_property_readonly("sample_type", [](const AudioData& a) { return a.sampleType; })
+        .def_property_readonly("format", [](const AudioData& a) { return a.format; })
         .def_property_readonly("frames", [](const AudioData& a) { return a.totalFrames; })
         .def_property_readonly("samples", [](const AudioData& a) { return a.totalSamples; })
         .def_property_readonly("duration", [](const AudioData& a) { return a.durationSeconds; })
         .def_property_readonly("path", [](const AudioData& a) { return a.sourcePath; })
+        .def_property_readonly("seek_points", [](const AudioData& a) { return a.seekPoints; })
         .def_property_readonly("surround", [](const AudioData& a) { return a.forceMono; })
+        .def_property_readonly("decoded_size", &AudioData::decodedSize)
         .def("decode", [](const AudioData& a)
         {
-            auto data = a.decode();
+            std::vector<uint8_t> data;
+            {
+                py::gil_scoped_release release;
+                data = a.decode();
+            }
             return py::bytes(reinterpret_cast<const char*>(data.data()), data.size());
-        });
+        })
+        .def("decode_pcm", &AudioData::decodePCM, py::call_guard<py::gil_scoped_release>())
+        // Decode into a caller-provided writable buffer, returns the frames written
+        .def("decode_into", [](const AudioData& a, py::buffer out)
+        {
+            py::buffer_info info = request_writable(out);
+            size_t frameSize = static_cast<size_t>(a.channels) * a.bytesPerSample;
+            uint64_t capacity = static_cast<size_t>(info.size * info.itemsize) / frameSize;
+            py::gil_scoped_release release;
+            return a.decodeInto(info.ptr, std::min(capacity, a.totalFrames));
+        }, py::arg("out"));
+
+    py::class_<Buffer, std::shared_ptr<Buffer>>(m, "Buffer")
+        .def(py::init<const AudioData&>(), py::call_guard<py::gil_scoped_release>())
+        .def(py::init<const PCMData&>(), py::call_guard<py::gil_scoped_release>())
+        // Decode and upload in one step, e.g. straight from downloaded bytes
+        // Only the decode and upload run without the GIL, pybind11 installs
+        // the returned holder with it held
+        .def(py::init([](const AssetSource& source, bool surround, std::optional<SampleType> type)
+            {
+                py::gil_scoped_release release;
+                return std::make_shared<Buffer>(AudioData(source, surround, type));
+            }),
+            py::arg("source"), py::arg("surround") = false, py::arg("sample_type") = SampleType::Int16)
+        .def_property_readonly("size", &Buffer::size)
+        .def_property_readonly("duration", &Buffer::duration)
+        .def_static("float32_supported", &Buffer::float32_supported)
+        .def_static("multichannel_supported", &Buffer::multichannel_supported);
 
-    py::class_<Buffer>(m, "Buffer")
-        .def(py::init<const AudioData&>());
+    py::class_<BufferCache>(m, "BufferCache")
+        .def_static("get", &BufferCache::get,
+            py::arg("path"), py::arg("surround") = false, py::arg("sample_type") = SampleType::Int16,
+            py::call_guard<py::gil_scoped_release>())
+        .def_property_static("budget",
+            [](py::object) { return BufferCache::get_budget(); },
+            [](py::object, size_t bytes) { BufferCache::set_budget(bytes); })
+        .def_property_readonly_static("bytes", [](py::object) { return BufferCache::get_bytes(); })
+        .def_property_readonly_static("count", [](py::object) { return BufferCache::get_count(); })
+        .def_static("clear", &BufferCache::clear);
+
+    m.def("load_buffers", &BatchLoader::load,
+        py::arg("paths"), py::arg("threads") = 0, py::arg("surround") = false,
+        py::arg("sample_type") = SampleType::Int16,
+        py::call_guard<py::gil_scoped_release>());
 
     py::class_<Source>(m, "Source")
         .def(py::init<>())
@@ -72,6 +355,113 @@ PYBIND11_MODULE(pyopenalsoft, m) {
         .def("set_velocity", &Source::set_velocity, py::arg("x"), py::arg("y"), py::arg("z"))
         .def("reset", &Source::reset);
 
+    // Voices are plain handles, each keeps its pool alive from Python
+    py::class_<Voice>(m, "Voice")
+        .def_property_readonly("valid", &Voice::valid)
+        .def_property_readonly("playing", &Voice::is_playing)
+        .def_property_readonly("priority", &Voice::priority)
+        .def_property_readonly("id", &Voice::id)
+        .def("play", &Voice::play)
+        .def("pause", &Voice::pause)
+        .def("stop", &Voice::stop)
+        .def("set_buffer", &Voice::set_buffer, py::arg("buffer"))
+        .def("set_looping", &Voice::set_looping, py::arg("loop"))
+        .def("set_gain", &Voice::set_gain, py::arg("gain"))
+        .def("set_pitch", &Voice::set_pitch, py::arg("pitch"))
+        .def("set_relative", &Voice::set_relative, py::arg("relative"))
+        .def("set_reference_distance", &Voice::set_reference_distance, py::arg("distance"))
+        .def("set_rolloff_factor", &Voice::set_rolloff_factor, py::arg("factor"))
+        .def("set_max_distance", &Voice::set_max_distance, py::arg("distance"))
+        .def("set_position", &Voice::set_position, py::arg("x"), py::arg("y"), py::arg("z"))
+        .def("set_velocity", &Voice::set_velocity, py::arg("x"), py::arg("y"), py::arg("z"))
+        .def_property("offset", &Voice::offset, &Voice::set_offset);
+
+    py::enum_<SourceState>(m, "SourceState", py::arithmetic())
+        .value("INITIAL", SourceState::Initial)
+        .value("PLAYING", SourceState::Playing)
+        .value("PAUSED", SourceState::Paused)
+        .value("STOPPED", SourceState::Stopped);
+
+    // Bulk setters take an N x 3 / N array (float32 passes through without a
+    // copy) or a sequence; indices=None addresses every source
+    py::class_<SourceGroup>(m, "SourceGroup")
+        .def(py::init<size_t>(), py::arg("size"))
+        .def("__len__", &SourceGroup::size)
+        .def_property_readonly("size", &SourceGroup::size)
+        .def("id", &SourceGroup::id, py::arg("index"))
+        .def("set_positions", [](SourceGroup& g, const py::object& xyz)
+            {
+                with_float_rows(xyz, g.size(), 3, [&](const float* rows) { g.set_positions(rows); });
+            }, py::arg("positions"))
+        .def("set_velocities", [](SourceGroup& g, const py::object& xyz)
+            {
+                with_float_rows(xyz, g.size(), 3, [&](const float* rows) { g.set_velocities(rows); });
+            }, py::arg("velocities"))
+        .def("set_gains", [](SourceGroup& g, const py::object& gains)
+            {
+                with_float_rows(gains, g.size(), 1, [&](const float* rows) { g.set_gains(rows); });
+            }, py::arg("gains"))
+        .def("set_pitches", [](SourceGroup& g, const py::object& pitches)
+            {
+                with_float_rows(pitches, g.size(), 1, [&](const float* rows) { g.set_pitches(rows); });
+            }, py::arg("pitches"))
+        .def("set_buffer", &SourceGroup::set_buffer,
+             py::arg("buffer"), py::arg("indices") = std::vector<uint32_t>())
+        .def("set_looping", &SourceGroup::set_looping,
+             py::arg("loop"), py::arg("indices") = std::vector<uint32_t>())
+        .def("play", &SourceGroup::play, py::arg("indices") = std::vector<uint32_t>())
+        .def("stop", &SourceGroup::stop, py::arg("indices") = std::vector<uint32_t>())
+        .def("pause", &SourceGroup::pause, py::arg("indices") = std::vector<uint32_t>())
+        // list[SourceState], one entry per source in index order
+        .def("states", [](const SourceGroup& g)
+            {
+                std::vector<SourceState> states(g.size());
+                g.states(states.data());
+                return states;
+            })
+        .def_property_readonly("playing_count", &SourceGroup::playing_count);
+
+    py::class_<SourcePool, std::shared_ptr<SourcePool>>(m, "SourcePool")
+        .def(py::init<size_t>(), py::arg("size"))
+        // None when every voice is busy at a higher priority
+        .def("acquire", &SourcePool::acquire, py::arg("priority") = 0, py::keep_alive<0, 1>())
+        .def("update", &SourcePool::update)
+        // False when every voice is busy at a higher priority
+        .def("play_oneshot", [](SourcePool& p, std::shared_ptr<const Buffer> buffer, const std::array<float, 3>& position,
+                                float gain, float pitch, int priority)
+            {
+                return p.play_oneshot(std::move(buffer), position[0], position[1], position[2], gain, pitch, priority);
+            }, py::arg("buffer"), py::arg("position") = std::array<float, 3>{ 0.0f, 0.0f, 0.0f },
+               py::arg("gain") = 1.0f, py::arg("pitch") = 1.0f, py::arg("priority") = 0)
+        .def_property_readonly("size", &SourcePool::size)
+        .def_property_readonly("free", &SourcePool::free_count)
+        .def_property_readonly("active", &SourcePool::active_count)
+        .def_property_readonly("steals", &SourcePool::steals);
+
+    // Emitters are ids; only the most audible ones hold a real source
+    py::class_<EmitterPool>(m, "EmitterPool")
+        .def(py::init<size_t, float>(), py::arg("voices"), py::arg("threshold") = 0.001f)
+        .def("play", [](EmitterPool& p, std::shared_ptr<const Buffer> buffer, const std::array<float, 3>& position,
+                        float gain, float pitch, bool looping, int priority)
+            {
+                return p.play(std::move(buffer), position[0], position[1], position[2], gain, pitch, looping, priority);
+            }, py::arg("buffer"), py::arg("position") = std::array<float, 3>{ 0.0f, 0.0f, 0.0f },
+               py::arg("gain") = 1.0f, py::arg("pitch") = 1.0f, py::arg("looping") = false, py::arg("priority") = 0)
+        .def("stop", &EmitterPool::stop, py::arg("id"))
+        .def("set_position", &EmitterPool::set_position, py::arg("id"), py::arg("x"), py::arg("y"), py::arg("z"))
+        .def("set_gain", &EmitterPool::set_gain, py::arg("id"), py::arg("gain"))
+        .def("set_pitch", &EmitterPool::set_pitch, py::arg("id"), py::arg("pitch"))
+        .def("set_distances", &EmitterPool::set_distances, py::arg("id"), py::arg("reference_distance"),
+             py::arg("max_distance") = FLT_MAX, py::arg("rolloff_factor") = 1.0f)
+        .def("is_playing", &EmitterPool::is_playing, py::arg("id"))
+        .def("is_real", &EmitterPool::is_real, py::arg("id"))
+        .def("offset", &EmitterPool::offset, py::arg("id"))
+        .def("update", &EmitterPool::update)
+        .def_property("threshold", &EmitterPool::threshold, &EmitterPool::set_threshold)
+        .def_property_readonly("voices", &EmitterPool::voices)
+        .def_property_readonly("emitters", &EmitterPool::emitter_count)
+        .def_property_readonly("real", &EmitterPool::real_count);
+
     py::enum_<DistanceModel>(m, "DistanceModel")
         .value("NONE", DistanceModel::None)
         .value("INVERSE", DistanceModel::Inverse)
@@ -93,18 +483,33 @@ PYBIND11_MODULE(pyopenalsoft, m) {
         .def_static("reset", &Listener::reset);
 
     py::class_<Stream>(m, "Stream")
-        .def(py::init<const std::string&, size_t>(), py::arg("path"), py::arg("buffer_size") = 65536)
-        .def("update", &Stream::update)
+        .def(py::init<const AssetSource&, size_t, bool, size_t, bool, std::optional<SampleType>>(),
+             py::arg("path"), py::arg("buffer_size") = 65536, py::arg("background") = false,
+             py::arg("buffer_count") = 4, py::arg("adaptive") = false,
+             py::arg("sample_type") = SampleType::Int16,
+             py::call_guard<py::gil_scoped_release>())
+        .def("update", &Stream::update, py::call_guard<py::gil_scoped_release>())
         .def("play", &Stream::play)
         .def("pause", &Stream::pause)
-        .def("stop", &Stream::stop)
+        .def("stop", &Stream::stop, py::call_guard<py::gil_scoped_release>())
         .def_property("gain", &Stream::get_gain, &Stream::set_gain)
         .def_property("pitch", &Stream::get_pitch, &Stream::set_pitch)
-        .def_property("offset", &Stream::get_offset, &Stream::set_offset)
+        .def_property("offset", &Stream::get_offset,
+            py::cpp_function(&Stream::set_offset, py::call_guard<py::gil_scoped_release>()))
         .def_property("looping", &Stream::get_looping, &Stream::set_looping)
-        .def_property("surround", &Stream::get_surround, &Stream::set_surround)
+        .def_property("surround", &Stream::get_surround,
+            py::cpp_function(&Stream::set_surround, py::call_guard<py::gil_scoped_release>()))
+        .def_property("background", &Stream::get_background,
+            py::cpp_function(&Stream::set_background, py::call_guard<py::gil_scoped_release>()))
         .def("set_position", &Stream::set_position, py::arg("x"), py::arg("y"), py::arg("z"))
         .def("set_velocity", &Stream::set_velocity, py::arg("x"), py::arg("y"), py::arg("z"))
         .def_property_readonly("duration", &Stream::get_total_duration)
-        .def_property_readonly("progress", &Stream::get_progress);
+        .def_property_readonly("progress", &Stream::get_progress)
+        .def_property_readonly("scratch_allocations", &Stream::get_scratch_allocations)
+        .def_property("adaptive", &Stream::get_adaptive, &Stream::set_adaptive)
+        .def_property_readonly("buffer_count", &Stream::get_buffer_count)
+        .def_property_readonly("underruns", &Stream::get_underruns)
+        .def_property_readonly("error", &Stream::get_error)
+        .def_property_readonly("seek_points", &Stream::get_seek_points)
+        .def_property_readonly("sample_type", &Stream::get_sample_type);
 }
\ No newline at end of file
@@ -35,7 +35,10 @@ Source::~Source()
 Source::Source(Source&& other) noexcept
 {
     id_ = other.id_;
+    props_ = other.props_;
+    started_ = other.started_;
     other.id_ = 0;
+    other.started_ = false;
 }
 
 Source& Source::operator=(Source&& other) noexcept
@@ -45,15 +48,21 @@ Source& Source::operator=(Source&& other) noexcept
         if (id_)
             OpenALLoader::al().alDeleteSources(1, &id_);
         id_ = other.id_;
+        props_ = other.props_;
+        started_ = other.started_;
         other.id_ = 0;
+        other.started_ = false;
     }
     return *this;
 }
 
+// alSourcePlay restarts a playing source, so a source that may still be
+// running is checked first; a fresh, stopped or reset one is not
 void Source::play()
 {
-    if (is_playing()) return;
+    if (started_ && is_playing()) return;
     OpenALLoader::al().alSourcePlay(id_);
+    started_ = true;
 }
 
 void Source::pause()
@@ -64,10 +73,12 @@ void Source::pause()
 void Source::stop()
 {
     OpenALLoader::al().alSourceStop(id_);
+    started_ = false;
 }
 
 bool Source::is_playing() const
 {
+    if (!started_) return false;
     int state;
     OpenALLoader::al().alGetSourcei(id_, AL_SOURCE_STATE, &state);
     return state == AL_PLAYING;
@@ -75,6 +86,7 @@ bool Source::is_playing() const
 
 bool Source::is_paused() const
 {
+    if (!started_) return false;
     int state;
     OpenALLoader::al().alGetSourcei(id_, AL_SOURCE_STATE, &state);
     return state == AL_PAUSED;
@@ -94,19 +106,20 @@ void Source::set_buffer(const Buffer& buffer)
 
 void Source::set_looping(bool loop)
 {
+    props_.looping = loop;
     OpenALLoader::al().alSourcei(id_, AL_LOOPING, loop ? 1 : 0);
 }
 
 void Source::set_gain(float gain)
 {
-    float g = (gain < 0.0f) ? 0.0f : gain;
-    OpenALLoader::al().alSourcef(id_, AL_GAIN, g);
+    props_.gain = (gain >= 0.0f) ? gain : 0.0f;
+    OpenALLoader::al().alSourcef(id_, AL_GAIN, props_.gain);
 }
 
 void Source::set_pitch(float pitch)
 {
-    float p = (pitch < 0.001f) ? 0.001f : pitch;
-    OpenALLoader::al().alSourcef(id_, AL_PITCH, p);
+    props_.pitch = (pitch >= 0.001f) ? pitch : 0.001f;
+    OpenALLoader::al().alSourcef(id_, AL_PITCH, props_.pitch);
 }
 
 void Source::set_offset(float seconds)
@@ -116,43 +129,46 @@ void Source::set_offset(float seconds)
 
 void Source::set_relative(bool relative)
 {
+    props_.relative = relative;
     OpenALLoader::al().alSourcei(id_, AL_SOURCE_RELATIVE, relative ? 1 : 0);
 }
 
+// AL rejects negative distances and factors, leaving the value unchanged;
+// the mirror follows suit
 void Source::set_reference_distance(float distance)
 {
+    if (!(distance >= 0.0f)) return;
+    props_.referenceDistance = distance;
     OpenALLoader::al().alSourcef(id_, AL_REFERENCE_DISTANCE, distance);
 }
 
 void Source::set_rolloff_factor(float factor)
 {
+    if (!(factor >= 0.0f)) return;
+    props_.rolloffFactor = factor;
     OpenALLoader::al().alSourcef(id_, AL_ROLLOFF_FACTOR, factor);
 }
 
 void Source::set_max_distance(float distance)
 {
+    if (!(distance >= 0.0f)) return;
+    props_.maxDistance = distance;
     OpenALLoader::al().alSourcef(id_, AL_MAX_DISTANCE, distance);
 }
 
 bool Source::get_looping() const
 {
-    int loop;
-    OpenALLoader::al().alGetSourcei(id_, AL_LOOPING, &loop);
-    return loop == 1;
+    return props_.looping;
 }
 
 float Source::get_gain() const
 {
-    float gain;
-    OpenALLoader::al().alGetSourcef(id_, AL_GAIN, &gain);
-    return gain;
+    return props_.gain;
 }
 
 float Source::get_pitch() const
 {
-    float pitch;
-    OpenALLoader::al().alGetSourcef(id_, AL_PITCH, &pitch);
-    return pitch;
+    return props_.pitch;
 }
 
 float Source::get_offset() const
@@ -164,30 +180,22 @@ float Source::get_offset() const
 
 bool Source::get_relative() const
 {
-    int relative;
-    OpenALLoader::al().alGetSourcei(id_, AL_SOURCE_RELATIVE, &relative);
-    return relative == 1;
+    return props_.relative;
 }
 
 float Source::get_reference_distance() const
 {
-    float d;
-    OpenALLoader::al().alGetSourcef(id_, AL_REFERENCE_DISTANCE, &d);
-    return d;
+    return props_.referenceDistance;
 }
 
 float Source::get_rolloff_factor() const
 {
-    float f;
-    OpenALLoader::al().alGetSourcef(id_, AL_ROLLOFF_FACTOR, &f);
-    return f;
+    return props_.rolloffFactor;
 }
 
 float Source::get_max_distance() const
 {
-    float d;
-    OpenALLoader::al().alGetSourcef(id_, AL_MAX_DISTANCE, &d);
-    return d;
+    return props_.maxDistance;
 }
 
 void Source::set_position(float x, float y, float z)
@@ -203,6 +211,10 @@ void Source::set_velocity(float x, float y, float z)
 void Source::reset()
 {
     auto& al = OpenALLoader::al();
+    props_.gain = 1.0f;
+    props_.pitch = 1.0f;
+    props_.looping = false;
+    started_ = false;
 
     al.alSourceStop(id_);
     al.alSourcei(id_, AL_BUFFER, 0);
@@ -0,0 +1,200 @@
+#include <cstring>
+#include "source_group.h"
+
+
+constexpr int AL_BUFFER   = 0x1009;
+constexpr int AL_LOOPING  = 0x1007;
+constexpr int AL_GAIN     = 0x100A;
+constexpr int AL_PITCH    = 0x1003;
+constexpr int AL_POSITION = 0x1004;
+constexpr int AL_VELOCITY = 0x1006;
+
+constexpr int AL_SOURCE_STATE = 0x1010;
+constexpr int AL_PLAYING      = 0x1012;
+constexpr int AL_PAUSED       = 0x1013;
+constexpr int AL_STOPPED      = 0x1014;
+
+SourceGroup::SourceGroup(size_t size)
+    : ids_(size, 0), positions_(size * 3, 0.0f), velocities_(size * 3, 0.0f),
+      gains_(size, 1.0f), pitches_(size, 1.0f), looping_(size, 0), buffers_(size)
+{
+    if (size == 0) return;
+    OpenALLoader::al().alGenSources(static_cast<int>(size), ids_.data());
+    if (!ids_[0])
+        throw std::runtime_error("Failed to create " + std::to_string(size) + " OpenAL sources");
+    selected_.reserve(size);
+}
+
+SourceGroup::~SourceGroup()
+{
+    if (ids_.empty() || !ids_[0]) return;
+    auto& al = OpenALLoader::al();
+    al.alSourceStopv(static_cast<int>(ids_.size()), ids_.data());
+    al.alDeleteSources(static_cast<int>(ids_.size()), ids_.data());
+}
+
+unsigned int SourceGroup::id(size_t index) const
+{
+    if (index >= ids_.size())
+        throw std::runtime_error("SourceGroup index out of range");
+    return ids_[index];
+}
+
+const std::vector<unsigned int>& SourceGroup::select(const std::vector<uint32_t>& indices)
+{
+    if (indices.empty()) return ids_;
+    selected_.clear();
+    for (uint32_t index : indices)
+    {
+        if (index >= ids_.size())
+            throw std::runtime_error("SourceGroup index out of range");
+        selected_.push_back(ids_[index]);
+    }
+    return selected_;
+}
+
+void SourceGroup::set_positions(const float* xyz)
+{
+    auto& al = OpenALLoader::al();
+    for (size_t i = 0; i < ids_.size(); ++i)
+    {
+        const float* p = xyz + i * 3;
+        float* mirror = &positions_[i * 3];
+        if (std::memcmp(p, mirror, sizeof(float) * 3) == 0) continue;
+        std::memcpy(mirror, p, sizeof(float) * 3);
+        al.alSource3f(ids_[i], AL_POSITION, p[0], p[1], p[2]);
+    }
+}
+
+void SourceGroup::set_velocities(const float* xyz)
+{
+    auto& al = OpenALLoader::al();
+    for (size_t i = 0; i < ids_.size(); ++i)
+    {
+        const float* v = xyz + i * 3;
+        float* mirror = &velocities_[i * 3];
+        if (std::memcmp(v, mirror, sizeof(float) * 3) == 0) continue;
+        std::memcpy(mirror, v, sizeof(float) * 3);
+        al.alSource3f(ids_[i], AL_VELOCITY, v[0], v[1], v[2]);
+    }
+}
+
+void SourceGroup::set_gains(const float* gains)
+{
+    auto& al = OpenALLoader::al();
+    for (size_t i = 0; i < ids_.size(); ++i)
+    {
+        float g = (gains[i] < 0.0f) ? 0.0f : gains[i];
+        if (g == gains_[i]) continue;
+        gains_[i] = g;
+        al.alSourcef(ids_[i], AL_GAIN, g);
+    }
+}
+
+void SourceGroup::set_pitches(const float* pitches)
+{
+    auto& al = OpenALLoader::al();
+    for (size_t i = 0; i < ids_.size(); ++i)
+    {
+        float p = (pitches[i] < 0.001f) ? 0.001f : pitches[i];
+        if (p == pitches_[i]) continue;
+        pitches_[i] = p;
+        al.alSourcef(ids_[i], AL_PITCH, p);
+    }
+}
+
+// The group keeps each source's buffer alive while it is attached. AL only
+// swaps the buffer of a stopped source, so the selection is stopped first;
+// otherwise a playing source would keep a buffer the group no longer owns.
+void SourceGroup::set_buffer(std::shared_ptr<const Buffer> buffer, const std::vector<uint32_t>& indices)
+{
+    auto& al = OpenALLoader::al();
+    const auto& ids = select(indices);
+    if (ids.empty()) return;
+    al.alSourceStopv(static_cast<int>(ids.size()), ids.data());
+    int bufferId = buffer ? static_cast<int>(buffer->id()) : 0;
+    auto apply = [&](size_t i)
+    {
+        al.alSourcei(ids_[i], AL_BUFFER, bufferId);
+        buffers_[i] = buffer;
+    };
+    if (indices.empty())
+    {
+        for (size_t i = 0; i < ids_.size(); ++i) apply(i);
+        return;
+    }
+    for (uint32_t index : indices)
+        apply(index);
+}
+
+void SourceGroup::set_looping(bool loop, const std::vector<uint32_t>& indices)
+{
+    auto& al = OpenALLoader::al();
+    uint8_t value = loop ? 1 : 0;
+    auto apply = [&](size_t i)
+    {
+        if (looping_[i] == value) return;
+        looping_[i] = value;
+        al.alSourcei(ids_[i], AL_LOOPING, value);
+    };
+    if (indices.empty())
+    {
+        for (size_t i = 0; i < ids_.size(); ++i) apply(i);
+        return;
+    }
+    // Range-checks every index before any source changes
+    select(indices);
+    for (uint32_t index : indices)
+        apply(index);
+}
+
+void SourceGroup::play(const std::vector<uint32_t>& indices)
+{
+    const auto& ids = select(indices);
+    if (!ids.empty())
+        OpenALLoader::al().alSourcePlayv(static_cast<int>(ids.size()), ids.data());
+}
+
+void SourceGroup::stop(const std::vector<uint32_t>& indices)
+{
+    const auto& ids = select(indices);
+    if (!ids.empty())
+        OpenALLoader::al().alSourceStopv(static_cast<int>(ids.size()), ids.data());
+}
+
+void SourceGroup::pause(const std::vector<uint32_t>& indices)
+{
+    const auto& ids = select(indices);
+    if (!ids.empty())
+        OpenALLoader::al().alSourcePausev(static_cast<int>(ids.size()), ids.data());
+}
+
+void SourceGroup::states(SourceState* out) const
+{
+    auto& al = OpenALLoader::al();
+    for (size_t i = 0; i < ids_.size(); ++i)
+    {
+        int state;
+        al.alGetSourcei(ids_[i], AL_SOURCE_STATE, &state);
+        switch (state)
+        {
+            case AL_PLAYING: out[i] = SourceState::Playing; break;
+            case AL_PAUSED:  out[i] = SourceState::Paused; break;
+            case AL_STOPPED: out[i] = SourceState::Stopped; break;
+            default:         out[i] = SourceState::Initial; break;
+        }
+    }
+}
+
+size_t SourceGroup::playing_count() const
+{
+    auto& al = OpenALLoader::al();
+    size_t count = 0;
+    for (unsigned int id : ids_)
+    {
+        int state;
+        al.alGetSourcei(id, AL_SOURCE_STATE, &state);
+        if (state == AL_PLAYING) ++count;
+    }
+    return count;
+}
@@ -0,0 +1,401 @@
+#include <cfloat>
+#include <cmath>
+#include "source_pool.h"
+
+
+constexpr int AL_BUFFER   = 0x1009;
+constexpr int AL_LOOPING  = 0x1007;
+constexpr int AL_GAIN     = 0x100A;
+constexpr int AL_PITCH    = 0x1003;
+constexpr int AL_POSITION = 0x1004;
+constexpr int AL_VELOCITY = 0x1006;
+constexpr int AL_SOURCE_RELATIVE = 0x202;
+
+constexpr int AL_REFERENCE_DISTANCE = 0x1020;
+constexpr int AL_ROLLOFF_FACTOR     = 0x1021;
+constexpr int AL_MAX_DISTANCE       = 0x1023;
+
+constexpr int AL_SEC_OFFSET = 0x1024;
+
+constexpr int AL_SOURCE_STATE = 0x1010;
+constexpr int AL_PLAYING      = 0x1012;
+constexpr int AL_STOPPED      = 0x1014;
+
+// Per-pool budget of slots polled on every acquire
+constexpr size_t RECLAIM_PER_ACQUIRE = 2;
+
+// Properties a voice changed away from the AL defaults
+enum DirtyBits : uint32_t
+{
+    DIRTY_BUFFER    = 1 << 0,
+    DIRTY_LOOPING   = 1 << 1,
+    DIRTY_GAIN      = 1 << 2,
+    DIRTY_PITCH     = 1 << 3,
+    DIRTY_RELATIVE  = 1 << 4,
+    DIRTY_REFERENCE = 1 << 5,
+    DIRTY_ROLLOFF   = 1 << 6,
+    DIRTY_MAX_DIST  = 1 << 7,
+    DIRTY_POSITION  = 1 << 8,
+    DIRTY_VELOCITY  = 1 << 9
+};
+
+SourcePool::SourcePool(size_t size)
+{
+    auto& al = OpenALLoader::al();
+    ids_.assign(size, 0);
+    if (size > 0)
+        al.alGenSources(static_cast<int>(size), ids_.data());
+    // A batch past the device limit fails as a whole; take what is left one by one
+    if (size > 0 && ids_[0] == 0)
+    {
+        size_t count = 0;
+        while (count < size)
+        {
+            al.alGenSources(1, &ids_[count]);
+            if (!ids_[count]) break;
+            ++count;
+        }
+        ids_.resize(count);
+    }
+    if (ids_.empty())
+        throw std::runtime_error("Failed to create OpenAL sources for the pool");
+
+    slots_.resize(ids_.size());
+    free_.reserve(ids_.size());
+    for (size_t i = ids_.size(); i-- > 0;)
+        free_.push_back(static_cast<uint32_t>(i));
+}
+
+SourcePool::~SourcePool()
+{
+    close();
+}
+
+void SourcePool::close()
+{
+    if (ids_.empty()) return;
+    // Sources go first so the buffers they hold can be deleted afterwards
+    auto& al = OpenALLoader::al();
+    for (unsigned int id : ids_)
+        al.alSourceStop(id);
+    al.alDeleteSources(static_cast<int>(ids_.size()), ids_.data());
+    ids_.clear();
+    slots_.clear();
+    free_.clear();
+    reclaimCursor_ = 0;
+}
+
+std::optional<Voice> SourcePool::acquire(int priority)
+{
+    reclaim_some(RECLAIM_PER_ACQUIRE);
+    if (free_.empty())
+        update();
+    if (free_.empty())
+    {
+        auto victim = pick_victim(priority);
+        if (!victim) return std::nullopt;
+        release(*victim, true);
+        ++steals_;
+    }
+    uint32_t index = free_.back();
+    free_.pop_back();
+    Slot& slot = slots_[index];
+    slot.state = SlotState::Reserved;
+    slot.priority = priority;
+    return Voice(this, index, slot.generation);
+}
+
+bool SourcePool::reclaim_if_stopped(uint32_t index)
+{
+    if (slots_[index].state != SlotState::Playing) return false;
+    int state;
+    OpenALLoader::al().alGetSourcei(ids_[index], AL_SOURCE_STATE, &state);
+    if (state != AL_STOPPED) return false;
+    release(index, false);
+    return true;
+}
+
+size_t SourcePool::update()
+{
+    size_t reclaimed = 0;
+    for (uint32_t i = 0; i < slots_.size(); ++i)
+        reclaimed += reclaim_if_stopped(i);
+    return reclaimed;
+}
+
+// Round-robin poll of a few slots, so finished voices flow back a little
+// at a time instead of in one full scan when the pool runs dry
+void SourcePool::reclaim_some(size_t count)
+{
+    for (size_t checked = 0; checked < count && checked < slots_.size(); ++checked)
+    {
+        reclaim_if_stopped(reclaimCursor_);
+        reclaimCursor_ = (reclaimCursor_ + 1) % static_cast<uint32_t>(slots_.size());
+    }
+}
+
+// Detaches the buffer and invalidates outstanding handles. Properties the
+// voice changed are only reset when the next voice plays without setting
+// them itself, so a one-shot that sets everything pays nothing extra.
+void SourcePool::release(uint32_t index, bool stopSource)
+{
+    auto& al = OpenALLoader::al();
+    Slot& slot = slots_[index];
+    unsigned int id = ids_[index];
+    if (stopSource)
+        al.alSourceStop(id);
+    if (slot.dirty & DIRTY_BUFFER)
+        al.alSourcei(id, AL_BUFFER, 0);
+
+    uint32_t generation = slot.generation + 1;
+    uint32_t stale = (slot.stale | slot.dirty) & ~DIRTY_BUFFER;
+    slot = Slot();
+    slot.generation = generation;
+    slot.stale = stale;
+    free_.push_back(index);
+}
+
+void SourcePool::flush_stale(uint32_t index)
+{
+    auto& al = OpenALLoader::al();
+    Slot& slot = slots_[index];
+    unsigned int id = ids_[index];
+    uint32_t stale = slot.stale;
+    if (stale & DIRTY_LOOPING)   al.alSourcei(id, AL_LOOPING, 0);
+    if (stale & DIRTY_GAIN)      al.alSourcef(id, AL_GAIN, 1.0f);
+    if (stale & DIRTY_PITCH)     al.alSourcef(id, AL_PITCH, 1.0f);
+    if (stale & DIRTY_RELATIVE)  al.alSourcei(id, AL_SOURCE_RELATIVE, 0);
+    if (stale & DIRTY_REFERENCE) al.alSourcef(id, AL_REFERENCE_DISTANCE, 1.0f);
+    if (stale & DIRTY_ROLLOFF)   al.alSourcef(id, AL_ROLLOFF_FACTOR, 1.0f);
+    if (stale & DIRTY_MAX_DIST)  al.alSourcef(id, AL_MAX_DISTANCE, FLT_MAX);
+    if (stale & DIRTY_POSITION)  al.alSource3f(id, AL_POSITION, 0.0f, 0.0f, 0.0f);
+    if (stale & DIRTY_VELOCITY)  al.alSource3f(id, AL_VELOCITY, 0.0f, 0.0f, 0.0f);
+    slot.stale = 0;
+}
+
+bool SourcePool::play_oneshot(std::shared_ptr<const Buffer> buffer, float x, float y, float z,
+                              float gain, float pitch, int priority)
+{
+    auto voice = acquire(priority);
+    if (!voice) return false;
+    voice->set_buffer(std::move(buffer));
+    voice->set_position(x, y, z);
+    voice->set_gain(gain);
+    voice->set_pitch(pitch);
+    voice->play();
+    return true;
+}
+
+// Rough loudness for ranking: gain times inverse-distance attenuation
+float SourcePool::audibility(const Slot& slot, const float* listener) const
+{
+    float dx = slot.position[0], dy = slot.position[1], dz = slot.position[2];
+    if (!slot.relative)
+    {
+        dx -= listener[0];
+        dy -= listener[1];
+        dz -= listener[2];
+    }
+    float distance = std::sqrt(dx * dx + dy * dy + dz * dz);
+    float reference = slot.referenceDistance;
+    if (distance <= reference || reference <= 0.0f)
+        return slot.gain;
+    return slot.gain * reference / (reference + slot.rolloffFactor * (distance - reference));
+}
+
+std::optional<uint32_t> SourcePool::pick_victim(int priority) const
+{
+    float listener[3] = { 0.0f, 0.0f, 0.0f };
+    OpenALLoader::al().alGetListenerfv(AL_POSITION, listener);
+
+    std::optional<uint32_t> victim;
+    int victimPriority = 0;
+    float victimLevel = 0.0f;
+    for (uint32_t i = 0; i < slots_.size(); ++i)
+    {
+        const Slot& slot = slots_[i];
+        if (slot.state == SlotState::Free || slot.priority > priority) continue;
+        float level = audibility(slot, listener);
+        if (!victim || slot.priority < victimPriority ||
+            (slot.priority == victimPriority && level < victimLevel))
+        {
+            victim = i;
+            victimPriority = slot.priority;
+            victimLevel = level;
+        }
+    }
+    return victim;
+}
+
+SourcePool::Slot* SourcePool::slot_for(const Voice& voice)
+{
+    if (voice.slot_ >= slots_.size()) return nullptr;
+    Slot& slot = slots_[voice.slot_];
+    if (slot.generation != voice.generation_ || slot.state == SlotState::Free) return nullptr;
+    return &slot;
+}
+
+const SourcePool::Slot* SourcePool::slot_for(const Voice& voice) const
+{
+    return const_cast<SourcePool*>(this)->slot_for(voice);
+}
+
+bool Voice::valid() const
+{
+    return pool_->slot_for(*this) != nullptr;
+}
+
+bool Voice::is_playing() const
+{
+    const SourcePool::Slot* slot = pool_->slot_for(*this);
+    if (!slot || slot->state != SourcePool::SlotState::Playing) return false;
+    int state;
+    OpenALLoader::al().alGetSourcei(pool_->ids_[slot_], AL_SOURCE_STATE, &state);
+    return state == AL_PLAYING;
+}
+
+int Voice::priority() const
+{
+    const SourcePool::Slot* slot = pool_->slot_for(*this);
+    return slot ? slot->priority : 0;
+}
+
+unsigned int Voice::id() const
+{
+    return valid() ? pool_->ids_[slot_] : 0;
+}
+
+void Voice::play()
+{
+    SourcePool::Slot* slot = pool_->slot_for(*this);
+    if (!slot) return;
+    if (slot->stale)
+        pool_->flush_stale(slot_);
+    slot->state = SourcePool::SlotState::Playing;
+    OpenALLoader::al().alSourcePlay(pool_->ids_[slot_]);
+}
+
+void Voice::pause()
+{
+    if (pool_->slot_for(*this))
+        OpenALLoader::al().alSourcePause(pool_->ids_[slot_]);
+}
+
+// A stopped voice is finished, its source goes straight back to the pool
+void Voice::stop()
+{
+    if (pool_->slot_for(*this))
+        pool_->release(slot_, true);
+}
+
+void Voice::set_buffer(std::shared_ptr<const Buffer> buffer)
+{
+    SourcePool::Slot* slot = pool_->slot_for(*this);
+    if (!slot) return;
+    OpenALLoader::al().alSourcei(pool_->ids_[slot_], AL_BUFFER, buffer ? static_cast<int>(buffer->id()) : 0);
+    slot->buffer = std::move(buffer);
+    slot->dirty |= DIRTY_BUFFER;
+    slot->stale &= ~DIRTY_BUFFER;
+}
+
+void Voice::set_looping(bool loop)
+{
+    SourcePool::Slot* slot = pool_->slot_for(*this);
+    if (!slot) return;
+    OpenALLoader::al().alSourcei(pool_->ids_[slot_], AL_LOOPING, loop ? 1 : 0);
+    slot->dirty |= DIRTY_LOOPING;
+    slot->stale &= ~DIRTY_LOOPING;
+}
+
+void Voice::set_gain(float gain)
+{
+    SourcePool::Slot* slot = pool_->slot_for(*this);
+    if (!slot) return;
+    slot->gain = (gain < 0.0f) ? 0.0f : gain;
+    OpenALLoader::al().alSourcef(pool_->ids_[slot_], AL_GAIN, slot->gain);
+    slot->dirty |= DIRTY_GAIN;
+    slot->stale &= ~DIRTY_GAIN;
+}
+
+void Voice::set_pitch(float pitch)
+{
+    SourcePool::Slot* slot = pool_->slot_for(*this);
+    if (!slot) return;
+    OpenALLoader::al().alSourcef(pool_->ids_[slot_], AL_PITCH, (pitch < 0.001f) ? 0.001f : pitch);
+    slot->dirty |= DIRTY_PITCH;
+    slot->stale &= ~DIRTY_PITCH;
+}
+
+void Voice::set_relative(bool relative)
+{
+    SourcePool::Slot* slot = pool_->slot_for(*this);
+    if (!slot) return;
+    slot->relative = relative;
+    OpenALLoader::al().alSourcei(pool_->ids_[slot_], AL_SOURCE_RELATIVE, relative ? 1 : 0);
+    slot->dirty |= DIRTY_RELATIVE;
+    slot->stale &= ~DIRTY_RELATIVE;
+}
+
+void Voice::set_reference_distance(float distance)
+{
+    SourcePool::Slot* slot = pool_->slot_for(*this);
+    if (!slot || !(distance >= 0.0f)) return;
+    slot->referenceDistance = distance;
+    OpenALLoader::al().alSourcef(pool_->ids_[slot_], AL_REFERENCE_DISTANCE, distance);
+    slot->dirty |= DIRTY_REFERENCE;
+    slot->stale &= ~DIRTY_REFERENCE;
+}
+
+void Voice::set_rolloff_factor(float factor)
+{
+    SourcePool::Slot* slot = pool_->slot_for(*this);
+    if (!slot || !(factor >= 0.0f)) return;
+    slot->rolloffFactor = factor;
+    OpenALLoader::al().alSourcef(pool_->ids_[slot_], AL_ROLLOFF_FACTOR, factor);
+    slot->dirty |= DIRTY_ROLLOFF;
+    slot->stale &= ~DIRTY_ROLLOFF;
+}
+
+void Voice::set_max_distance(float distance)
+{
+    SourcePool::Slot* slot = pool_->slot_for(*this);
+    if (!slot || !(distance >= 0.0f)) return;
+    OpenALLoader::al().alSourcef(pool_->ids_[slot_], AL_MAX_DISTANCE, distance);
+    slot->dirty |= DIRTY_MAX_DIST;
+    slot->stale &= ~DIRTY_MAX_DIST;
+}
+
+void Voice::set_position(float x, float y, float z)
+{
+    SourcePool::Slot* slot = pool_->slot_for(*this);
+    if (!slot) return;
+    slot->position[0] = x;
+    slot->position[1] = y;
+    slot->position[2] = z;
+    OpenALLoader::al().alSource3f(pool_->ids_[slot_], AL_POSITION, x, y, z);
+    slot->dirty |= DIRTY_POSITION;
+    slot->stale &= ~DIRTY_POSITION;
+}
+
+void Voice::set_velocity(float x, float y, float z)
+{
+    SourcePool::Slot* slot = pool_->slot_for(*this);
+    if (!slot) return;
+    OpenALLoader::al().alSource3f(pool_->ids_[slot_], AL_VELOCITY, x, y, z);
+    slot->dirty |= DIRTY_VELOCITY;
+    slot->stale &= ~DIRTY_VELOCITY;
+}
+
+void Voice::set_offset(float seconds)
+{
+    if (!pool_->slot_for(*this)) return;
+    OpenALLoader::al().alSourcef(pool_->ids_[slot_], AL_SEC_OFFSET, seconds < 0.0f ? 0.0f : seconds);
+}
+
+float Voice::offset() const
+{
+    if (!pool_->slot_for(*this)) return 0.0f;
+    float seconds = 0.0f;
+    OpenALLoader::al().alGetSourcef(pool_->ids_[slot_], AL_SEC_OFFSET, &seconds);
+    return seconds;
+}
@@ -1,8 +1,7 @@
-#define STB_VORBIS_HEADER_ONLY
 #include "stream.h"
-#include "dr_wav.h"
-#include "dr_mp3.h"
-#include "stb_vorbis.c"
+#include "stream_worker.h"
+#include "buffer.h"
+#include "mix_kernels.h"
 
 
 constexpr int AL_POSITION       = 0x1004;
@@ -17,109 +16,73 @@ constexpr int AL_BUFFERS_PROCESSED  = 0x1015;
 constexpr int AL_BUFFERS_QUEUED     = 0x1016;
 constexpr int AL_SEC_OFFSET      = 0x1024;
 
-constexpr int AL_FORMAT_MONO16   = 0x1101;
-constexpr int AL_FORMAT_STEREO16 = 0x1103;
 
+// Adaptive queue depth tuning
+constexpr size_t ADAPTIVE_MAX_FACTOR  = 4;
+constexpr size_t SHRINK_AFTER_REFILLS = 64;
 
-enum StreamFormat { FMT_WAV, FMT_MP3, FMT_OGG };
-
-Stream::Stream(const std::string& path, size_t bufferSize) 
-    : path_(path), bufferSize_(bufferSize), playing_(false)
+Stream::Stream(const AssetSource& source, size_t bufferSize, bool background, size_t bufferCount, bool adaptive,
+               std::optional<SampleType> type) 
+    : bufferCount_(bufferCount), adaptive_(adaptive), path_(source.describe()), bufferSize_(bufferSize), playing_(false), background_(background)
 {
+    if (bufferCount == 0)
+        throw std::runtime_error("Stream needs at least one buffer: " + path_);
+    decoder_ = Decoder::open(source);
+    channels_ = decoder_->channels();
+    sampleRate_ = decoder_->sample_rate();
+    sampleType_ = type.value_or(decoder_->native_sample_type());
+    frameSize_ = channels_ * sample_size(sampleType_);
+    alFormat_ = Buffer::format_for(static_cast<uint16_t>(channels_), sampleType_);
+    // A sidecar index also carries the frame count, so load (or write) it
+    // up front; otherwise the seek table waits for the first seek
+    if (Decoder::get_seek_index_enabled())
+        decoder_->build_seek_table();
+    duration_ = static_cast<float>(decoder_->frame_count()) / sampleRate_;
+    bufferIds_.resize(bufferCount);
     OpenALLoader::al().alGenSources(1, &sourceId_);
-    OpenALLoader::al().alGenBuffers(4, bufferIds_);
-    std::string ext = path.substr(path.find_last_of(".") + 1);
-    std::transform(ext.begin(), ext.end(), ext.begin(), ::tolower);
-    if (ext == "wav")
-    {
-        drwav* wav = new drwav();
-        if (drwav_init_file(wav, path.c_str(), nullptr))
-        {
-            handle_ = wav; format_ = FMT_WAV;
-            channels_ = wav->channels; sampleRate_ = wav->sampleRate;
-        }
-    }
-    else if (ext == "mp3")
-    {
-        drmp3* mp3 = new drmp3();
-        if (drmp3_init_file(mp3, path.c_str(), nullptr))
-        {
-            handle_ = mp3; format_ = FMT_MP3;
-            channels_ = mp3->channels; sampleRate_ = mp3->sampleRate;
-        }
-    }
-    else if (ext == "ogg")
-    {
-        int err;
-        stb_vorbis* ogg = stb_vorbis_open_filename(path.c_str(), &err, nullptr);
-        if (ogg)
-        {
-            handle_ = ogg; format_ = FMT_OGG;
-            stb_vorbis_info info = stb_vorbis_get_info(ogg);
-            channels_ = info.channels; sampleRate_ = info.sample_rate;
-        }
-    }
-    if (!handle_) throw std::runtime_error("Stream init failed: " + path);
-    else
-    {
-        uint64_t totalFrames = 0;
-        if (format_ == FMT_WAV) totalFrames = ((drwav*)handle_)->totalPCMFrameCount;
-        else if (format_ == FMT_MP3) totalFrames = drmp3_get_pcm_frame_count((drmp3*)handle_);
-        else if (format_ == FMT_OGG) totalFrames = stb_vorbis_stream_length_in_samples((stb_vorbis*)handle_);
-        duration_ = static_cast<float>(totalFrames) / sampleRate_;
-    }
-    alFormat_ = (channels_ == 1) ? AL_FORMAT_MONO16 : AL_FORMAT_STEREO16;
+    OpenALLoader::al().alGenBuffers(static_cast<int>(bufferIds_.size()), bufferIds_.data());
     OpenALLoader::al().alSourcei(sourceId_, AL_LOOPING, 0); 
     OpenALLoader::al().alSourceRewind(sourceId_);
     OpenALLoader::al().alSourcei(sourceId_, AL_BUFFER, 0);
     samplesProcessed_ = 0;
-    for (int i = 0; i < 4; ++i)
-    {
-        if (fill_buffer(bufferIds_[i])) 
-        OpenALLoader::al().alSourceQueueBuffers(sourceId_, 1, &bufferIds_[i]);
-    }
+    if (background_)
+        ring_.resize(ring_capacity());
+    refill_queue();
     samplesProcessed_ = 0;
     OpenALLoader::al().alSourceStop(sourceId_);
+    if (background_)
+        StreamWorker::add(this);
 }
 
 Stream::~Stream()
 {
+    if (background_)
+        StreamWorker::remove(this);
     if (sourceId_)
     {
         OpenALLoader::al().alSourceStop(sourceId_);
         clear_queue();
         OpenALLoader::al().alDeleteSources(1, &sourceId_);
     }
-    OpenALLoader::al().alDeleteBuffers(4, bufferIds_);
-    clear_handle();
+    OpenALLoader::al().alDeleteBuffers(static_cast<int>(bufferIds_.size()), bufferIds_.data());
 }
 
-bool Stream::fill_buffer(unsigned int alBufferId) {
-    size_t samplesNeeded = bufferSize_ / sizeof(int16_t);
-    std::vector<int16_t> pcm(samplesNeeded);
+// Read up to `frames` frames from the decoder, wrapping to the start when looping
+size_t Stream::read_frames(uint8_t* out, size_t frames)
+{
     size_t totalFramesRead = 0;
-    size_t framesToRead = samplesNeeded / channels_;
-    while (totalFramesRead < framesToRead)
+    while (totalFramesRead < frames)
     {
-        uint64_t framesReadThisIteration = 0;
-        size_t remainingFrames = framesToRead - totalFramesRead;
-        int16_t* writePtr = pcm.data() + (totalFramesRead * channels_);
-        if (format_ == FMT_WAV)
-            framesReadThisIteration = drwav_read_pcm_frames_s16((drwav*)handle_, remainingFrames, writePtr);
-        else if (format_ == FMT_MP3)
-            framesReadThisIteration = drmp3_read_pcm_frames_s16((drmp3*)handle_, remainingFrames, writePtr);
-        else if (format_ == FMT_OGG)
-        {
-            int samples = stb_vorbis_get_samples_short_interleaved((stb_vorbis*)handle_, channels_, writePtr, (int)(remainingFrames * channels_));
-            framesReadThisIteration = (samples > 0) ? (samples / channels_) : 0;
-        }
+        size_t remainingFrames = frames - totalFramesRead;
+        uint8_t* writePtr = out + (totalFramesRead * frameSize_);
+        uint64_t framesReadThisIteration = (sampleType_ == SampleType::Float32)
+            ? decoder_->read(reinterpret_cast<float*>(writePtr), remainingFrames)
+            : decoder_->read(reinterpret_cast<int16_t*>(writePtr), remainingFrames);
         if (framesReadThisIteration == 0)
         {
             if (looping_)
             {
-                if (format_ == FMT_WAV) drwav_seek_to_pcm_frame((drwav*)handle_, 0);
-                else if (format_ == FMT_MP3) drmp3_seek_to_pcm_frame((drmp3*)handle_, 0);
-                else if (format_ == FMT_OGG) stb_vorbis_seek_start((stb_vorbis*)handle_);
+                seek_frame(0);
                 if (totalFramesRead == 0 && framesReadThisIteration == 0) break; 
                 continue;
             }
@@ -128,21 +91,47 @@ bool Stream::fill_buffer(unsigned int alBufferId) {
         }
         totalFramesRead += framesReadThisIteration;
     }
+    return totalFramesRead;
+}
+
+uint8_t* Stream::scratch(size_t bytes)
+{
+    if (scratchSize_ < bytes)
+    {
+        scratch_.reset(new uint8_t[bytes]);
+        scratchSize_ = bytes;
+        ++scratchAllocations_;
+    }
+    return scratch_.get();
+}
+
+bool Stream::fill_buffer(unsigned int alBufferId) {
+    size_t framesToRead = bufferSize_ / frameSize_;
+    uint8_t* pcm = scratch(framesToRead * frameSize_);
+    // Anything the worker decoded ahead goes first; the rest is decoded
+    // inline unless the worker owns the decoder
+    size_t totalFramesRead = ring_.read(pcm, framesToRead * frameSize_) / frameSize_;
+    if (!background_)
+        totalFramesRead += read_frames(pcm + totalFramesRead * frameSize_, framesToRead - totalFramesRead);
     if (totalFramesRead == 0) return false;
     int currentFormat = alFormat_;
-    size_t finalByteSize = totalFramesRead * channels_ * sizeof(int16_t);
-    if (surround_ && channels_ == 2)
+    size_t finalByteSize = totalFramesRead * frameSize_;
+    if (surround_ && channels_ > 1)
     {
-        for (uint64_t i = 0; i < totalFramesRead; ++i)
+        if (sampleType_ == SampleType::Float32)
+        {
+            float* samples = reinterpret_cast<float*>(pcm);
+            downmix_mono(samples, samples, static_cast<uint16_t>(channels_), totalFramesRead);
+        }
+        else
         {
-            int32_t left = pcm[i * 2];
-            int32_t right = pcm[i * 2 + 1];
-            pcm[i] = static_cast<int16_t>((left + right) / 2);
+            int16_t* samples = reinterpret_cast<int16_t*>(pcm);
+            downmix_mono(samples, samples, static_cast<uint16_t>(channels_), totalFramesRead);
         }
-        currentFormat = AL_FORMAT_MONO16;
-        finalByteSize = totalFramesRead * 1 * sizeof(int16_t);
+        currentFormat = Buffer::format_for(1, sampleType_);
+        finalByteSize = totalFramesRead * sample_size(sampleType_);
     }
-    OpenALLoader::al().alBufferData(alBufferId, currentFormat, pcm.data(), (int)finalByteSize, sampleRate_);
+    OpenALLoader::al().alBufferData(alBufferId, currentFormat, pcm, (int)finalByteSize, sampleRate_);
     samplesProcessed_ += totalFramesRead;    
     uint64_t totalFileFrames = static_cast<uint64_t>(duration_ * sampleRate_);
     if (looping_ && totalFileFrames > 0)
@@ -152,14 +141,16 @@ bool Stream::fill_buffer(unsigned int alBufferId) {
 
 void Stream::update()
 {
+    if (background_) return;
+    std::scoped_lock lock(decodeMutex_, queueMutex_);
     int processed;
     OpenALLoader::al().alGetSourcei(sourceId_, AL_BUFFERS_PROCESSED, &processed);
     while (processed-- > 0)
     {
         unsigned int bufferId = 0;
         OpenALLoader::al().alSourceUnqueueBuffers(sourceId_, 1, &bufferId);
-        if (bufferId != 0 && fill_buffer(bufferId))
-            OpenALLoader::al().alSourceQueueBuffers(sourceId_, 1, &bufferId);
+        if (bufferId != 0)
+            recycle_buffer(bufferId);
     }
     int state;
     OpenALLoader::al().alGetSourcei(sourceId_, AL_SOURCE_STATE, &state);
@@ -167,10 +158,13 @@ void Stream::update()
         int queued;
         OpenALLoader::al().alGetSourcei(sourceId_, AL_BUFFERS_QUEUED, &queued);
         if (queued > 0)
+        {
+            on_underrun();
             OpenALLoader::al().alSourcePlay(sourceId_);
+        }
         else if (looping_)
         {
-            set_offset(0.0f); 
+            restart_at(0); 
             OpenALLoader::al().alSourcePlay(sourceId_);
         }
         else
@@ -178,8 +172,120 @@ void Stream::update()
     }
 }
 
+void Stream::service_decode()
+{
+    if (failed_) return;
+    std::lock_guard lock(decodeMutex_);
+    decode_ahead();
+}
+
+// Top up the ring from the decoder; caller holds decodeMutex_
+void Stream::decode_ahead()
+{
+    if (decoderEnded_ && looping_)
+    {
+        seek_frame(0);
+        decoderEnded_ = false;
+    }
+    bool wrapped = false;
+    while (!decoderEnded_)
+    {
+        size_t count = 0;
+        uint8_t* region = ring_.write_region(count);
+        size_t frames = count / frameSize_;
+        if (frames == 0) break;
+        size_t framesRead = read_frames(region, frames);
+        if (framesRead == 0)
+        {
+            // read_frames stops right after rewinding a looping stream
+            if (looping_ && !wrapped) { wrapped = true; continue; }
+            if (!looping_) decoderEnded_ = true;
+            break;
+        }
+        wrapped = false;
+        ring_.commit_write(framesRead * frameSize_);
+    }
+}
+
+// Requeue processed AL buffers from the ring and recover from underruns
+void Stream::service_queue()
+{
+    if (failed_) return;
+    std::lock_guard lock(queueMutex_);
+    size_t bufferBytes = (bufferSize_ / frameSize_) * frameSize_;
+    int processed;
+    OpenALLoader::al().alGetSourcei(sourceId_, AL_BUFFERS_PROCESSED, &processed);
+    // Only hand out full buffers until the decoder has reached the end
+    while (processed > 0 && (ring_.available() >= bufferBytes || decoderEnded_))
+    {
+        unsigned int bufferId = 0;
+        OpenALLoader::al().alSourceUnqueueBuffers(sourceId_, 1, &bufferId);
+        if (bufferId != 0)
+            recycle_buffer(bufferId);
+        --processed;
+    }
+    int state;
+    OpenALLoader::al().alGetSourcei(sourceId_, AL_SOURCE_STATE, &state);
+    if (playing_ && state != AL_PLAYING)
+    {
+        int queued;
+        OpenALLoader::al().alGetSourcei(sourceId_, AL_BUFFERS_QUEUED, &queued);
+        if (queued > 0)
+        {
+            on_underrun();
+            OpenALLoader::al().alSourcePlay(sourceId_);
+        }
+        else if (decoderEnded_ && ring_.available() == 0 && !looping_)
+            playing_ = false;
+    }
+}
+
+void Stream::set_background(bool enable)
+{
+    if (background_ == enable) return;
+    if (enable)
+    {
+        {
+            std::scoped_lock lock(decodeMutex_, queueMutex_);
+            if (ring_.capacity() == 0)
+                ring_.resize(ring_capacity());
+            decoderEnded_ = false;
+            background_ = true;
+        }
+        StreamWorker::add(this);
+    }
+    else
+    {
+        // Whatever is left in the ring is drained by the next update() calls
+        StreamWorker::remove(this);
+        background_ = false;
+    }
+}
+
+void Stream::fail(const std::string& what)
+{
+    {
+        std::lock_guard lock(errorMutex_);
+        if (error_.empty())
+            error_ = what + ": " + path_;
+    }
+    failed_ = true;
+    playing_ = false;
+    OpenALLoader::al().alSourceStop(sourceId_);
+}
+
+std::optional<std::string> Stream::get_error() const
+{
+    if (!failed_) return std::nullopt;
+    std::lock_guard lock(errorMutex_);
+    return error_;
+}
+
 void Stream::play()
 {
+    if (failed_)
+        throw std::runtime_error(*get_error());
+    std::lock_guard lock(queueMutex_);
     playing_ = true;
     int state;
     OpenALLoader::al().alGetSourcei(sourceId_, AL_SOURCE_STATE, &state);
@@ -188,86 +294,125 @@ void Stream::play()
 
 void Stream::pause()
 {
+    std::lock_guard lock(queueMutex_);
     playing_ = false;
     OpenALLoader::al().alSourcePause(sourceId_);
 }
 
 void Stream::stop()
 {
+    std::scoped_lock lock(decodeMutex_, queueMutex_);
     playing_ = false;
     OpenALLoader::al().alSourceStop(sourceId_);
+    restart_at(0);
+}
+
+void Stream::seek_frame(uint64_t frame)
+{
+    // Seeking an MP3 without a table decodes from the start of the file,
+    // rewinding to the start needs none
+    if (frame > 0)
+        decoder_->build_seek_table();
+    decoder_->seek(frame);
+}
+
+// Drop everything queued or decoded ahead and start over at `frame`; caller
+// holds both mutexes
+void Stream::restart_at(uint64_t frame)
+{
+    seek_frame(frame);
+    ring_.reset();
+    decoderEnded_ = false;
     clear_queue();
-    if (format_ == FMT_WAV) drwav_seek_to_pcm_frame((drwav*)handle_, 0);
-    else if (format_ == FMT_MP3) drmp3_seek_to_pcm_frame((drmp3*)handle_, 0);
-    else if (format_ == FMT_OGG) stb_vorbis_seek_start((stb_vorbis*)handle_);
-    for (int i = 0; i < 4; ++i)
+    refill_queue();
+    samplesProcessed_ = frame;
+    if (playing_)
+        OpenALLoader::al().alSourcePlay(sourceId_);
+}
+
+void Stream::refill_queue()
+{
+    if (background_)
+        decode_ahead();
+    for (unsigned int& bufferId : bufferIds_)
     {
-        if (fill_buffer(bufferIds_[i]))
-            OpenALLoader::al().alSourceQueueBuffers(sourceId_, 1, &bufferIds_[i]);
+        if (fill_buffer(bufferId))
+            OpenALLoader::al().alSourceQueueBuffers(sourceId_, 1, &bufferId);
     }
-    samplesProcessed_ = 0;
 }
 
-void Stream::clear_handle() 
+// Refill and requeue a processed buffer, or retire it once an adaptive
+// stream has been stable for a while; caller holds queueMutex_
+void Stream::recycle_buffer(unsigned int alBufferId)
 {
-    if (!handle_) return;
-    switch (format_)
+    if (adaptive_ && bufferIds_.size() > bufferCount_ && ++stableRefills_ >= SHRINK_AFTER_REFILLS)
     {
-        case FMT_WAV: delete static_cast<drwav*>(handle_); break;
-        case FMT_MP3: delete static_cast<drmp3*>(handle_); break;
-        case FMT_OGG: stb_vorbis_close(static_cast<stb_vorbis*>(handle_)); break;
+        stableRefills_ = 0;
+        bufferIds_.erase(std::find(bufferIds_.begin(), bufferIds_.end(), alBufferId));
+        OpenALLoader::al().alDeleteBuffers(1, &alBufferId);
+        return;
     }
-    handle_ = nullptr;
+    if (fill_buffer(alBufferId))
+        OpenALLoader::al().alSourceQueueBuffers(sourceId_, 1, &alBufferId);
 }
 
-void Stream::clear_queue()
+// The source ran dry while it should be playing; caller holds queueMutex_
+void Stream::on_underrun()
 {
-    OpenALLoader::al().alSourceRewind(sourceId_); 
-    OpenALLoader::al().alSourcei(sourceId_, AL_BUFFER, 0); 
+    ++underruns_;
+    stableRefills_ = 0;
+    if (!adaptive_ || bufferIds_.size() >= bufferCount_ * ADAPTIVE_MAX_FACTOR) return;
+    unsigned int bufferId = 0;
+    OpenALLoader::al().alGenBuffers(1, &bufferId);
+    if (!bufferId) return;
+    if (fill_buffer(bufferId))
+    {
+        bufferIds_.push_back(bufferId);
+        OpenALLoader::al().alSourceQueueBuffers(sourceId_, 1, &bufferId);
+    }
+    else
+        OpenALLoader::al().alDeleteBuffers(1, &bufferId);
 }
 
-void Stream::set_gain(float gain)
+size_t Stream::get_buffer_count() const
 {
-    OpenALLoader::al().alSourcef(sourceId_, AL_GAIN, (gain < 0.0f) ? 0.0f : gain);
+    std::lock_guard lock(queueMutex_);
+    return bufferIds_.size();
 }
 
-float Stream::get_gain() const
+size_t Stream::ring_capacity() const
 {
-    float gain;
-    OpenALLoader::al().alGetSourcef(sourceId_, AL_GAIN, &gain);
-    return gain;
+    // Room for the configured AL queue plus as much again decoded ahead
+    size_t bufferFrames = bufferSize_ / frameSize_;
+    return bufferFrames * frameSize_ * bufferCount_ * 2;
 }
 
-void Stream::set_pitch(float pitch)
+void Stream::clear_queue()
 {
-    OpenALLoader::al().alSourcef(sourceId_, AL_PITCH, pitch);
+    OpenALLoader::al().alSourceRewind(sourceId_); 
+    OpenALLoader::al().alSourcei(sourceId_, AL_BUFFER, 0); 
 }
 
-float Stream::get_pitch() const
+void Stream::set_gain(float gain)
 {
-    float p;
-    OpenALLoader::al().alGetSourcef(sourceId_, AL_PITCH, &p);
-    return p;
+    gain_ = (gain >= 0.0f) ? gain : 0.0f;
+    OpenALLoader::al().alSourcef(sourceId_, AL_GAIN, gain_);
+}
+
+void Stream::set_pitch(float pitch)
+{
+    pitch_ = (pitch >= 0.001f) ? pitch : 0.001f;
+    OpenALLoader::al().alSourcef(sourceId_, AL_PITCH, pitch_);
 }
 
 void Stream::set_offset(float seconds) {
-    uint64_t frame = static_cast<uint64_t>(seconds * sampleRate_);
-    if (format_ == FMT_WAV) drwav_seek_to_pcm_frame((drwav*)handle_, frame);
-    else if (format_ == FMT_MP3) drmp3_seek_to_pcm_frame((drmp3*)handle_, frame);
-    else if (format_ == FMT_OGG) stb_vorbis_seek_frame((stb_vorbis*)handle_, (int)frame);
-    clear_queue();
-    for (int i = 0; i < 4; ++i)
-    {
-        if (fill_buffer(bufferIds_[i]))
-            OpenALLoader::al().alSourceQueueBuffers(sourceId_, 1, &bufferIds_[i]);
-    }
-    samplesProcessed_ = frame;
-    if (playing_)
-        OpenALLoader::al().alSourcePlay(sourceId_);
+    std::scoped_lock lock(decodeMutex_, queueMutex_);
+    restart_at(static_cast<uint64_t>(seconds * sampleRate_));
 }
 
 float Stream::get_offset() const
 {
+    std::lock_guard lock(queueMutex_);
     int state;
     OpenALLoader::al().alGetSourcei(sourceId_, AL_SOURCE_STATE, &state);
     float bufferOffset;
@@ -276,7 +421,7 @@ float Stream::get_offset() const
     OpenALLoader::al().alGetSourcei(sourceId_, AL_BUFFERS_PROCESSED, &processed);
     OpenALLoader::al().alGetSourcei(sourceId_, AL_BUFFERS_QUEUED, &queued);
     float totalOffset = (static_cast<float>(samplesProcessed_) / sampleRate_) - 
-                        ((queued * (bufferSize_ / (channels_ * sizeof(int16_t)))) / sampleRate_) + 
+                        ((queued * (bufferSize_ / frameSize_)) / sampleRate_) + 
                         bufferOffset;
     return std::clamp(totalOffset, 0.0f, duration_);
 }
@@ -0,0 +1,104 @@
+#include <algorithm>
+#include <chrono>
+#include "stream_worker.h"
+#include "stream.h"
+
+
+constexpr auto DECODE_INTERVAL = std::chrono::milliseconds(10);
+constexpr auto FEED_INTERVAL   = std::chrono::milliseconds(5);
+
+void StreamWorker::add(Stream* stream)
+{
+    std::lock_guard control(controlMutex_);
+    {
+        std::lock_guard lock(decodeListMutex_);
+        decodeList_.push_back(stream);
+    }
+    {
+        std::lock_guard lock(feedListMutex_);
+        feedList_.push_back(stream);
+    }
+    if (!running_)
+    {
+        running_ = true;
+        decodeThread_ = std::thread(&StreamWorker::decode_loop);
+        feedThread_ = std::thread(&StreamWorker::feed_loop);
+    }
+}
+
+void StreamWorker::remove(Stream* stream)
+{
+    std::lock_guard control(controlMutex_);
+    bool empty;
+    {
+        std::lock_guard lock(decodeListMutex_);
+        decodeList_.erase(std::remove(decodeList_.begin(), decodeList_.end(), stream), decodeList_.end());
+    }
+    {
+        std::lock_guard lock(feedListMutex_);
+        feedList_.erase(std::remove(feedList_.begin(), feedList_.end(), stream), feedList_.end());
+        empty = feedList_.empty();
+    }
+    if (empty)
+        stop_threads();
+}
+
+// Streams still registered fall back to foreground mode, so update() feeds
+// them on the calling thread instead of letting them run dry
+void StreamWorker::shutdown()
+{
+    std::lock_guard control(controlMutex_);
+    stop_threads();
+    {
+        std::lock_guard lock(decodeListMutex_);
+        decodeList_.clear();
+    }
+    {
+        std::lock_guard lock(feedListMutex_);
+        for (Stream* stream : feedList_)
+            stream->background_ = false;
+        feedList_.clear();
+    }
+}
+
+// Caller holds controlMutex_
+void StreamWorker::stop_threads()
+{
+    running_ = false;
+    if (decodeThread_.joinable()) decodeThread_.join();
+    if (feedThread_.joinable()) feedThread_.join();
+}
+
+void StreamWorker::decode_loop()
+{
+    while (running_)
+    {
+        {
+            std::lock_guard lock(decodeListMutex_);
+            for (Stream* stream : decodeList_)
+            {
+                try { stream->service_decode(); }
+                catch (const std::exception& e) { stream->fail(e.what()); }
+                catch (...) { stream->fail("unknown error"); }
+            }
+        }
+        std::this_thread::sleep_for(DECODE_INTERVAL);
+    }
+}
+
+void StreamWorker::feed_loop()
+{
+    while (running_)
+    {
+        {
+            std::lock_guard lock(feedListMutex_);
+            for (Stream* stream : feedList_)
+            {
+                try { stream->service_queue(); }
+                catch (const std::exception& e) { stream->fail(e.what()); }
+                catch (...) { stream->fail("unknown error"); }
+            }
+        }
+        std::this_thread::sleep_for(FEED_INTERVAL);
+    }
+}